@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+
+/** Location of dormant actors, out of the way of every level. */
+#define RL_POOL_DORMANT_LOCATION FVector(10000.f)
+
+/**
+ * Pool of actors of a single class, spawned up front and reused with O(1) acquire and release.
+ * Released actors are dormant: hidden, without collision and without tick, so they cost nothing while they wait.
+ */
+template<typename T>
+class TRlActorPool
+{
+public:
+	/** Called once on every spawned actor, e.g. to set its sprite. */
+	TFunction<void(T*)> OnSpawned;
+
+	/** Called after an actor leaves the pool, once it is placed and active again. */
+	TFunction<void(T*)> OnAcquired;
+
+	/** Called before an actor goes back to the pool. */
+	TFunction<void(T*)> OnReleased;
+
+	TRlActorPool() : Owner(nullptr), NumActive(0) {};
+
+	void Init(AActor* InOwner)
+	{
+		Owner = InOwner;
+	}
+
+	/** Spawns dormant actors until the pool holds at least Num of them. */
+	void Prewarm(int32 Num)
+	{
+		while (Actors.Num() < Num)
+		{
+			Spawn();
+		}
+	}
+
+	/** Takes a dormant actor and activates it at the given transform, spawning a new one only when the pool is empty. */
+	T* Acquire(const FVector& Location, const FRotator& Rotation)
+	{
+		if (!FreeIndices.Num())
+		{
+			Spawn();
+		}
+
+		const int32 Index = FreeIndices.Pop(false);
+		T* Actor = Actors[Index];
+		Active[Index] = true;
+		++NumActive;
+
+		Actor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		SetDormant(Actor, false);
+
+		if (OnAcquired)
+		{
+			OnAcquired(Actor);
+		}
+
+		return Actor;
+	}
+
+	/** Returns an active actor to the pool. Does nothing if the actor is not an active actor of this pool. */
+	void Release(T* Actor)
+	{
+		const int32* Index = Indices.Find(Actor);
+		if (!Index || !Active[*Index])
+		{
+			return;
+		}
+
+		if (OnReleased)
+		{
+			OnReleased(Actor);
+		}
+
+		SetDormant(Actor, true);
+		Actor->SetActorLocation(RL_POOL_DORMANT_LOCATION);
+
+		Active[*Index] = false;
+		FreeIndices.Push(*Index);
+		--NumActive;
+	}
+
+	void ReleaseAll()
+	{
+		for (int32 Index = 0; Index < Actors.Num() && NumActive; ++Index)
+		{
+			if (Active[Index])
+			{
+				Release(Actors[Index]);
+			}
+		}
+	}
+
+	/** Destroys every actor, active or not. */
+	void DestroyAll()
+	{
+		for (T* Actor : Actors)
+		{
+			if (Actor && !Actor->IsPendingKill())
+			{
+				Actor->Destroy();
+			}
+		}
+
+		Actors.Reset();
+		FreeIndices.Reset();
+		Active.Reset();
+		Indices.Reset();
+		NumActive = 0;
+	}
+
+	template<typename FunctionType>
+	void ForEachActive(FunctionType Function) const
+	{
+		for (int32 Index = 0; Index < Actors.Num(); ++Index)
+		{
+			if (Active[Index])
+			{
+				Function(Actors[Index]);
+			}
+		}
+	}
+
+	int32 Num() const { return Actors.Num(); }
+
+	/** Index of the actor in spawn order, INDEX_NONE if it is not from this pool. */
+	int32 GetIndex(T* Actor) const
+	{
+		const int32* Index = Indices.Find(Actor);
+		return Index ? *Index : INDEX_NONE;
+	}
+
+	int32 GetNumActive() const { return NumActive; }
+
+	static void SetDormant(AActor* Actor, bool bDormant)
+	{
+		Actor->SetActorHiddenInGame(bDormant);
+		Actor->SetActorEnableCollision(!bDormant);
+		Actor->SetActorTickEnabled(!bDormant);
+	}
+
+private:
+	AActor* Owner;
+
+	TArray<T*> Actors;
+
+	/** Stack of the indices of the dormant actors. */
+	TArray<int32> FreeIndices;
+
+	TBitArray<> Active;
+
+	TMap<T*, int32> Indices;
+
+	int32 NumActive;
+
+	void Spawn()
+	{
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.Owner = Owner;
+		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		T* Actor = Owner->GetWorld()->SpawnActor<T>(RL_POOL_DORMANT_LOCATION, FRotator(0.f), SpawnInfo);
+		SetDormant(Actor, true);
+
+		if (OnSpawned)
+		{
+			OnSpawned(Actor);
+		}
+
+		Indices.Add(Actor, Actors.Add(Actor));
+		FreeIndices.Push(Actors.Num() - 1);
+		Active.Add(false);
+	}
+};
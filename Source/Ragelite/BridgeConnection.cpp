@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BridgeConnection.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Runtime/Networking/Public/Common/TcpSocketBuilder.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBridge, Log, All);
+
+FRlBridgeConnection::FRlBridgeConnection(const FIPv4Endpoint& InEndpoint, uint32 QueueSize)
+	: ReconnectInterval(1.f)
+	, Endpoint(InEndpoint)
+	, Socket(nullptr)
+	, Thread(nullptr)
+	, Queue(QueueSize)
+	, bStopping(false)
+	, bConnected(false)
+	, AdvertisementWatcherState(-1)
+	, HeartRateState(-1)
+{
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("FRlBridgeConnection"), 0, TPri_BelowNormal);
+}
+
+FRlBridgeConnection::~FRlBridgeConnection()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	Disconnect();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+bool FRlBridgeConnection::Send(const FRlBridgeCommand& Command)
+{
+	if (!Queue.Enqueue(Command))
+	{
+		UE_LOG(LogBridge, Warning, TEXT("Send queue full, dropping command %i"), (int32)Command.Id);
+		return false;
+	}
+
+	WorkEvent->Trigger();
+	return true;
+}
+
+void FRlBridgeConnection::SetStickyState(ERlBridgeCommand Id, int8 State)
+{
+	if (Id == ERlBridgeCommand::AdvertisementWatcher)
+	{
+		AdvertisementWatcherState = State;
+	}
+	else if (Id == ERlBridgeCommand::HeartRate)
+	{
+		HeartRateState = State;
+	}
+}
+
+int8 FRlBridgeConnection::GetStickyState(ERlBridgeCommand Id) const
+{
+	if (Id == ERlBridgeCommand::AdvertisementWatcher)
+	{
+		return AdvertisementWatcherState;
+	}
+	if (Id == ERlBridgeCommand::HeartRate)
+	{
+		return HeartRateState;
+	}
+	return -1;
+}
+
+uint32 FRlBridgeConnection::Run()
+{
+	const uint32 WaitTime = FMath::Max(1, FMath::RoundToInt(ReconnectInterval * 1000.f));
+
+	while (!bStopping)
+	{
+		if (!bConnected)
+		{
+			if (!Connect() || !SendStickyStates())
+			{
+				Disconnect();
+				WorkEvent->Wait(WaitTime);
+				continue;
+			}
+		}
+
+		// Only dequeue once the frame is on the wire, a failed command is retried after reconnecting.
+		FRlBridgeCommand Command;
+		while (!bStopping && Queue.Peek(Command))
+		{
+			if (!SendFrame(Command))
+			{
+				Disconnect();
+				break;
+			}
+			Queue.Dequeue(Command);
+		}
+
+		if (bConnected)
+		{
+			WorkEvent->Wait(WaitTime);
+		}
+	}
+
+	// Best effort flush, so commands queued while shutting down (e.g. stopping the heart rate) still reach the bridge.
+	FRlBridgeCommand Command;
+	while (bConnected && Queue.Dequeue(Command))
+	{
+		if (!SendFrame(Command))
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+void FRlBridgeConnection::Stop()
+{
+	bStopping = true;
+	WorkEvent->Trigger();
+}
+
+bool FRlBridgeConnection::Connect()
+{
+	Socket = FTcpSocketBuilder(TEXT("FRlBridgeConnection")).AsBlocking().WithSendBufferSize(1024);
+	if (!Socket)
+	{
+		return false;
+	}
+
+	if (!Socket->Connect(*Endpoint.ToInternetAddr()))
+	{
+		return false;
+	}
+
+	UE_LOG(LogBridge, Log, TEXT("Connected to bridge at %s"), *Endpoint.ToString());
+	bConnected = true;
+	return true;
+}
+
+void FRlBridgeConnection::Disconnect()
+{
+	if (Socket)
+	{
+		if (bConnected)
+		{
+			UE_LOG(LogBridge, Log, TEXT("Disconnected from bridge"));
+		}
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+	bConnected = false;
+}
+
+bool FRlBridgeConnection::SendFrame(const FRlBridgeCommand& Command)
+{
+	uint8 Frame[RlBridge::FrameHeaderSize + RlBridge::MaxPayloadSize];
+
+	Frame[0] = Command.Size & 0xff;
+	Frame[1] = (Command.Size >> 8) & 0xff;
+	Frame[2] = (uint8)Command.Id;
+	FMemory::Memcpy(Frame + RlBridge::FrameHeaderSize, Command.Payload, Command.Size);
+
+	const int32 FrameSize = RlBridge::FrameHeaderSize + Command.Size;
+	int32 TotalSent = 0;
+
+	while (TotalSent < FrameSize)
+	{
+		int32 Sent = 0;
+		if (!Socket->Send(Frame + TotalSent, FrameSize - TotalSent, Sent) || Sent <= 0)
+		{
+			return false;
+		}
+		TotalSent += Sent;
+	}
+
+	return true;
+}
+
+bool FRlBridgeConnection::SendStickyStates()
+{
+	const int8 Advertisement = AdvertisementWatcherState;
+	if (Advertisement != -1 && !SendFrame(FRlBridgeCommand(ERlBridgeCommand::AdvertisementWatcher, &Advertisement, 1)))
+	{
+		return false;
+	}
+
+	const int8 HeartRate = HeartRateState;
+	if (HeartRate != -1 && !SendFrame(FRlBridgeCommand(ERlBridgeCommand::HeartRate, &HeartRate, 1)))
+	{
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Containers/CircularQueue.h"
+#include "Templates/Atomic.h"
+#include "Runtime/Networking/Public/Interfaces/IPv4/IPv4Endpoint.h"
+#include "BridgeProtocol.h"
+
+class FSocket;
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Long-lived outbound connection to the band bridge.
+ * The game thread only enqueues commands, a worker thread owns the socket, drains the queue and reconnects when the bridge goes away.
+ */
+class RAGELITE_API FRlBridgeConnection : public FRunnable
+{
+public:
+	FRlBridgeConnection(const FIPv4Endpoint& InEndpoint, uint32 QueueSize = 64);
+
+	virtual ~FRlBridgeConnection();
+
+	/** Queues a command. Never blocks, returns false if the queue is full and the command was dropped. Game thread only. */
+	bool Send(const FRlBridgeCommand& Command);
+
+	/** Remembers the last requested state of a toggle command, so it is sent again after a reconnect. -1 means unknown. */
+	void SetStickyState(ERlBridgeCommand Id, int8 State);
+
+	int8 GetStickyState(ERlBridgeCommand Id) const;
+
+	bool IsConnected() const { return bConnected; }
+
+	/** Seconds to wait between connection attempts. */
+	float ReconnectInterval;
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+private:
+	FIPv4Endpoint Endpoint;
+
+	FSocket* Socket;
+
+	FRunnableThread* Thread;
+
+	/** Triggered when a command is queued or the connection is stopped. */
+	FEvent* WorkEvent;
+
+	TCircularQueue<FRlBridgeCommand> Queue;
+
+	FThreadSafeBool bStopping;
+
+	FThreadSafeBool bConnected;
+
+	TAtomic<int8> AdvertisementWatcherState;
+
+	TAtomic<int8> HeartRateState;
+
+	bool Connect();
+
+	void Disconnect();
+
+	bool SendFrame(const FRlBridgeCommand& Command);
+
+	bool SendStickyStates();
+};
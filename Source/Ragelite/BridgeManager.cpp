@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BridgeManager.h"
+#include "BridgeConnection.h"
+#include "BridgeReceiver.h"
+#include "RlGameInstance.h"
+#include "Runtime/Networking/Public/Interfaces/IPv4/IPv4Address.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBridge, Log, All);
+
+void UBridgeManager::Init(URlGameInstance* InRlGI)
+{
+	RlGI = InRlGI;
+
+	if (RlGI->bUseDevice && !Connection)
+	{
+		Connection = new FRlBridgeConnection(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), RlBridge::CommandPort));
+	}
+}
+
+void UBridgeManager::Shutdown()
+{
+	StopReceiver();
+
+	if (Connection)
+	{
+		delete Connection;
+		Connection = nullptr;
+	}
+}
+
+void UBridgeManager::BeginDestroy()
+{
+	Shutdown();
+
+	Super::BeginDestroy();
+}
+
+void UBridgeManager::Vibrate()
+{
+	if (Connection)
+	{
+		Connection->Send(FRlBridgeCommand(ERlBridgeCommand::VibrateDefault));
+	}
+}
+
+void UBridgeManager::Vibrate(uint16 Milliseconds)
+{
+	if (Connection)
+	{
+		Connection->Send(FRlBridgeCommand(ERlBridgeCommand::Vibrate, &Milliseconds, sizeof(Milliseconds)));
+	}
+}
+
+void UBridgeManager::WriteMessage(const uint8* Message, uint32 MessageSize)
+{
+	if (!Connection)
+	{
+		return;
+	}
+
+	if (MessageSize > (uint32)RlBridge::MaxPayloadSize)
+	{
+		UE_LOG(LogBridge, Warning, TEXT("Message of %u bytes truncated to %i"), MessageSize, RlBridge::MaxPayloadSize);
+		MessageSize = RlBridge::MaxPayloadSize;
+	}
+
+	Connection->Send(FRlBridgeCommand(ERlBridgeCommand::WriteMessage, Message, MessageSize));
+}
+
+void UBridgeManager::HeartRate(bool bStart)
+{
+	if (Connection)
+	{
+		const uint8 State = bStart;
+		Connection->SetStickyState(ERlBridgeCommand::HeartRate, State);
+		Connection->Send(FRlBridgeCommand(ERlBridgeCommand::HeartRate, &State, 1));
+	}
+}
+
+void UBridgeManager::AdvertisementWatcher(bool bStart)
+{
+	if (!Connection || Connection->GetStickyState(ERlBridgeCommand::AdvertisementWatcher) == (int8)bStart)
+	{
+		return;
+	}
+
+	const uint8 State = bStart;
+	Connection->SetStickyState(ERlBridgeCommand::AdvertisementWatcher, State);
+	Connection->Send(FRlBridgeCommand(ERlBridgeCommand::AdvertisementWatcher, &State, 1));
+}
+
+void UBridgeManager::Connect(const FString& Device)
+{
+	if (!Connection)
+	{
+		return;
+	}
+
+	// The bridge stops watching when it starts connecting, forget the state so a failed attempt can restart it.
+	Connection->SetStickyState(ERlBridgeCommand::AdvertisementWatcher, -1);
+
+	FTCHARToUTF8 Message(*Device);
+	Connection->Send(FRlBridgeCommand(ERlBridgeCommand::Connect, Message.Get(), Message.Length()));
+}
+
+bool UBridgeManager::IsConnected() const
+{
+	return Connection && Connection->IsConnected();
+}
+
+void UBridgeManager::StartReceiver()
+{
+	if (RlGI->bUseDevice && !Receiver)
+	{
+		Receiver = new FRlBridgeReceiver(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), RlBridge::MessagePort));
+	}
+}
+
+void UBridgeManager::StopReceiver()
+{
+	if (Receiver)
+	{
+		delete Receiver;
+		Receiver = nullptr;
+	}
+}
+
+bool UBridgeManager::ReceiveMessage(FRlBridgeMessage& OutMessage)
+{
+	return Receiver && Receiver->Dequeue(OutMessage);
+}
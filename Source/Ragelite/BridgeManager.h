@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "BridgeManager.generated.h"
+
+class URlGameInstance;
+class FRlBridgeConnection;
+class FRlBridgeReceiver;
+struct FRlBridgeMessage;
+
+/**
+ * Owns the connection to the band bridge for the whole session.
+ * Every command is queued and sent from a worker thread, so none of them blocks the game thread.
+ */
+UCLASS()
+class RAGELITE_API UBridgeManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void Init(URlGameInstance* InRlGI);
+
+	void Shutdown();
+
+	virtual void BeginDestroy() override;
+
+	void Vibrate();
+
+	void Vibrate(uint16 Milliseconds);
+
+	/** Messages longer than RlBridge::MaxPayloadSize are truncated. */
+	void WriteMessage(const uint8* Message, uint32 MessageSize);
+
+	void HeartRate(bool bStart);
+
+	/** Only queued when the requested state changes, it is safe to call every frame. */
+	void AdvertisementWatcher(bool bStart);
+
+	void Connect(const FString& Device);
+
+	bool IsConnected() const;
+
+	/** Starts listening for the bridge messages. */
+	void StartReceiver();
+
+	void StopReceiver();
+
+	/** Pops the next message received from the bridge, call it until it returns false once per frame. */
+	bool ReceiveMessage(FRlBridgeMessage& OutMessage);
+
+private:
+	URlGameInstance* RlGI;
+
+	FRlBridgeConnection* Connection;
+
+	FRlBridgeReceiver* Receiver;
+};
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace RlBridge
+{
+	/** Port where the bridge listens for game commands. */
+	static const uint16 CommandPort = 1243;
+
+	/** Port where the game listens for bridge messages. */
+	static const uint16 MessagePort = 1242;
+
+	/** Largest payload a single command frame can carry. */
+	static const int32 MaxPayloadSize = 64;
+
+	/** Size of the frame header: uint16 payload size followed by the uint8 command id. */
+	static const int32 FrameHeaderSize = 3;
+}
+
+/** Commands sent from the game to the band bridge. The ids match the ones used by the old one-shot sockets. */
+enum class ERlBridgeCommand : uint8
+{
+	AdvertisementWatcher = 0x00,
+	Connect = 0x01,
+	WriteMessage = 0x02,
+	HeartRate = 0x03,
+	Vibrate = 0x04,
+	VibrateDefault = 0x05
+};
+
+/**
+ * A single command frame, written on the wire as [uint16 Size][uint8 Id][Payload].
+ * It has a fixed size so it can be queued without allocating.
+ */
+struct FRlBridgeCommand
+{
+	ERlBridgeCommand Id;
+
+	uint16 Size;
+
+	uint8 Payload[RlBridge::MaxPayloadSize];
+
+	FRlBridgeCommand() : Id(ERlBridgeCommand::VibrateDefault), Size(0) {};
+
+	FRlBridgeCommand(ERlBridgeCommand InId, const void* InPayload = nullptr, int32 InSize = 0)
+	{
+		Id = InId;
+		Size = FMath::Clamp(InSize, 0, RlBridge::MaxPayloadSize);
+		if (Size)
+		{
+			FMemory::Memcpy(Payload, InPayload, Size);
+		}
+	}
+};
+
+/** Messages sent from the band bridge to the game, framed the same way as the commands. */
+enum class ERlBridgeMessage : uint8
+{
+	/** Payload: 6 byte device address, most significant byte first. */
+	DeviceAdvert = 0x00,
+	/** No payload. */
+	Connected = 0x01,
+	/** Payload: uint8 beats per minute followed by the uint64 bridge timestamp in microseconds, little endian. */
+	HeartRate = 0x02
+};
+
+/** A decoded bridge message. Only the fields of its type are meaningful. */
+struct FRlBridgeMessage
+{
+	ERlBridgeMessage Type;
+
+	uint8 HeartRate;
+
+	/** Device address packed in the low 48 bits. */
+	uint64 Address;
+
+	uint64 Timestamp;
+
+	/** FPlatformTime cycles when the receiver decoded the message, set for every type. */
+	uint64 ReceiveCycles;
+
+	FRlBridgeMessage() : Type(ERlBridgeMessage::Connected), HeartRate(0), Address(0), Timestamp(0), ReceiveCycles(0) {};
+};
+
+namespace RlBridge
+{
+	/** Formats a packed device address as AA:BB:CC:DD:EE:FF. */
+	inline FString AddressToString(uint64 Address)
+	{
+		return FString::Printf(TEXT("%02X:%02X:%02X:%02X:%02X:%02X"),
+			(uint8)(Address >> 40), (uint8)(Address >> 32), (uint8)(Address >> 24),
+			(uint8)(Address >> 16), (uint8)(Address >> 8), (uint8)Address);
+	}
+}
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BridgeReceiver.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformTime.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Runtime/Networking/Public/Common/TcpSocketBuilder.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBridge, Log, All);
+
+namespace
+{
+	/** How long the worker blocks on a socket before checking if it has to stop. */
+	const FTimespan WaitTime = FTimespan::FromMilliseconds(100);
+}
+
+FRlBridgeReceiver::FRlBridgeReceiver(const FIPv4Endpoint& InEndpoint, uint32 QueueSize)
+	: Endpoint(InEndpoint)
+	, ListenSocket(nullptr)
+	, ConnectionSocket(nullptr)
+	, Thread(nullptr)
+	, Queue(QueueSize)
+	, bStopping(false)
+	, bConnected(false)
+	, BufferSize(0)
+{
+	ListenSocket = FTcpSocketBuilder(TEXT("FRlBridgeReceiver")).AsReusable().BoundToEndpoint(Endpoint).Listening(1);
+	if (!ListenSocket)
+	{
+		UE_LOG(LogBridge, Error, TEXT("Could not listen on %s"), *Endpoint.ToString());
+		return;
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("FRlBridgeReceiver"), 0, TPri_BelowNormal);
+}
+
+FRlBridgeReceiver::~FRlBridgeReceiver()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	CloseConnection();
+
+	if (ListenSocket)
+	{
+		ListenSocket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(ListenSocket);
+		ListenSocket = nullptr;
+	}
+}
+
+uint32 FRlBridgeReceiver::Run()
+{
+	while (!bStopping)
+	{
+		if (!ConnectionSocket)
+		{
+			Accept();
+		}
+		else
+		{
+			Receive();
+		}
+	}
+
+	return 0;
+}
+
+void FRlBridgeReceiver::Stop()
+{
+	bStopping = true;
+}
+
+void FRlBridgeReceiver::Accept()
+{
+	bool bPending = false;
+	if (!ListenSocket->WaitForPendingConnection(bPending, WaitTime) || !bPending)
+	{
+		return;
+	}
+
+	ConnectionSocket = ListenSocket->Accept(TEXT("FRlBridgeReceiver connection"));
+	if (ConnectionSocket)
+	{
+		UE_LOG(LogBridge, Log, TEXT("Bridge connected"));
+		BufferSize = 0;
+		bConnected = true;
+	}
+}
+
+void FRlBridgeReceiver::Receive()
+{
+	if (!ConnectionSocket->Wait(ESocketWaitConditions::WaitForRead, WaitTime))
+	{
+		return;
+	}
+
+	int32 Read = 0;
+	if (!ConnectionSocket->Recv(Buffer + BufferSize, sizeof(Buffer) - BufferSize, Read) || Read <= 0)
+	{
+		CloseConnection();
+		return;
+	}
+
+	BufferSize += Read;
+
+	if (!ParseFrames())
+	{
+		UE_LOG(LogBridge, Warning, TEXT("Malformed frame, dropping the bridge connection"));
+		CloseConnection();
+	}
+}
+
+bool FRlBridgeReceiver::ParseFrames()
+{
+	int32 Offset = 0;
+
+	while (BufferSize - Offset >= RlBridge::FrameHeaderSize)
+	{
+		const uint8* Frame = Buffer + Offset;
+		const int32 Size = Frame[0] | (Frame[1] << 8);
+
+		if (Size > RlBridge::MaxPayloadSize)
+		{
+			return false;
+		}
+
+		if (BufferSize - Offset < RlBridge::FrameHeaderSize + Size)
+		{
+			break;
+		}
+
+		if (!ParseMessage((ERlBridgeMessage)Frame[2], Frame + RlBridge::FrameHeaderSize, Size))
+		{
+			return false;
+		}
+
+		Offset += RlBridge::FrameHeaderSize + Size;
+	}
+
+	// Keep the partial frame at the front of the buffer.
+	BufferSize -= Offset;
+	if (Offset && BufferSize)
+	{
+		FMemory::Memmove(Buffer, Buffer + Offset, BufferSize);
+	}
+
+	return true;
+}
+
+bool FRlBridgeReceiver::ParseMessage(ERlBridgeMessage Type, const uint8* Payload, int32 Size)
+{
+	FRlBridgeMessage Message;
+	Message.Type = Type;
+	Message.ReceiveCycles = FPlatformTime::Cycles64();
+
+	switch (Type)
+	{
+	case ERlBridgeMessage::DeviceAdvert:
+		if (Size != 6)
+		{
+			return false;
+		}
+		for (int32 i = 0; i < 6; i++)
+		{
+			Message.Address = (Message.Address << 8) | Payload[i];
+		}
+		break;
+	case ERlBridgeMessage::Connected:
+		break;
+	case ERlBridgeMessage::HeartRate:
+		if (Size != 9)
+		{
+			return false;
+		}
+		Message.HeartRate = Payload[0];
+		for (int32 i = 8; i > 0; i--)
+		{
+			Message.Timestamp = (Message.Timestamp << 8) | Payload[i];
+		}
+		break;
+	default:
+		return false;
+	}
+
+	if (!Queue.Enqueue(Message))
+	{
+		UE_LOG(LogBridge, Warning, TEXT("Receive queue full, dropping message %i"), (int32)Type);
+	}
+
+	return true;
+}
+
+void FRlBridgeReceiver::CloseConnection()
+{
+	if (ConnectionSocket)
+	{
+		UE_LOG(LogBridge, Log, TEXT("Bridge disconnected"));
+		ConnectionSocket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(ConnectionSocket);
+		ConnectionSocket = nullptr;
+	}
+	bConnected = false;
+	BufferSize = 0;
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Containers/CircularQueue.h"
+#include "Runtime/Networking/Public/Interfaces/IPv4/IPv4Endpoint.h"
+#include "BridgeProtocol.h"
+
+class FSocket;
+class FRunnableThread;
+
+/**
+ * Listens for the band bridge and decodes its frames on a worker thread.
+ * Decoded messages are queued for the game thread, which drains them once per frame with Dequeue.
+ */
+class RAGELITE_API FRlBridgeReceiver : public FRunnable
+{
+public:
+	FRlBridgeReceiver(const FIPv4Endpoint& InEndpoint, uint32 QueueSize = 256);
+
+	virtual ~FRlBridgeReceiver();
+
+	/** Pops the oldest decoded message. Game thread only. */
+	bool Dequeue(FRlBridgeMessage& OutMessage) { return Queue.Dequeue(OutMessage); }
+
+	bool IsConnected() const { return bConnected; }
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+private:
+	FIPv4Endpoint Endpoint;
+
+	FSocket* ListenSocket;
+
+	FSocket* ConnectionSocket;
+
+	FRunnableThread* Thread;
+
+	TCircularQueue<FRlBridgeMessage> Queue;
+
+	FThreadSafeBool bStopping;
+
+	FThreadSafeBool bConnected;
+
+	/** Bytes received but not parsed yet, never more than one partial frame after ParseFrames. */
+	uint8 Buffer[1024];
+
+	int32 BufferSize;
+
+	void Accept();
+
+	void Receive();
+
+	/** Returns false if the stream is corrupt and the connection must be dropped. */
+	bool ParseFrames();
+
+	bool ParseMessage(ERlBridgeMessage Type, const uint8* Payload, int32 Size);
+
+	void CloseConnection();
+};
@@ -0,0 +1,319 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CollisionGrid.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Paper2D/Classes/PaperTileMap.h"
+#include "Paper2D/Classes/PaperTileMapComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCollisionGrid, Log, All);
+
+namespace
+{
+	/** Fraction of a cell ignored at the edges of a query, so touching a tile is not overlapping it. */
+	const float CellEdgeTolerance = 1e-3f;
+
+	FBox2D ToBox2D(const FBox& Box)
+	{
+		return FBox2D(FVector2D(Box.Min.X, Box.Min.Z), FVector2D(Box.Max.X, Box.Max.Z));
+	}
+}
+
+FRlCollisionGrid::FRlCollisionGrid()
+{
+	Reset();
+}
+
+void FRlCollisionGrid::Reset()
+{
+	Component = nullptr;
+	Origin = FVector2D::ZeroVector;
+	CellSize = 0.f;
+	Width = 0;
+	Height = 0;
+	WordsPerRow = 0;
+	Solid.Reset();
+	Partial.Reset();
+	Exact.Reset();
+}
+
+bool FRlCollisionGrid::Build(UPaperTileMapComponent* TileMapComponent)
+{
+	if (!TileMapComponent || !Build(TileMapComponent->TileMap, TileMapComponent->GetComponentTransform()))
+	{
+		return false;
+	}
+
+	Component = TileMapComponent;
+
+	UE_LOG(LogCollisionGrid, Verbose, TEXT("Built %ix%i collision grid from %s"), Width, Height, *TileMapComponent->GetName());
+
+	return true;
+}
+
+bool FRlCollisionGrid::Build(const UPaperTileMap* TileMap, const FTransform& Transform)
+{
+	Reset();
+
+	const UBodySetup* BodySetup = TileMap ? TileMap->BodySetup : nullptr;
+	if (!BodySetup || !BodySetup->AggGeom.GetElementCount() || TileMap->MapWidth <= 0 || TileMap->MapHeight <= 0)
+	{
+		return false;
+	}
+
+	const FVector Corner = Transform.TransformPosition(TileMap->GetTilePositionInLocalSpace(0.f, 0.f));
+	const FVector Center = Transform.TransformPosition(TileMap->GetTileCenterInLocalSpace(0.f, 0.f));
+
+	Origin = FVector2D(Corner.X, Corner.Z);
+	CellSize = 2.f * (Center.X - Corner.X);
+	Width = TileMap->MapWidth;
+	Height = TileMap->MapHeight;
+	WordsPerRow = (Width + 63) / 64;
+
+	if (CellSize <= 0.f)
+	{
+		Reset();
+		return false;
+	}
+
+	Solid.SetNumZeroed(WordsPerRow * Height);
+	Partial.SetNumZeroed(WordsPerRow * Height);
+
+	const FKAggregateGeom& AggGeom = BodySetup->AggGeom;
+
+	for (const FKBoxElem& Elem : AggGeom.BoxElems)
+	{
+		const FVector Extent(Elem.X * 0.5f, Elem.Y * 0.5f, Elem.Z * 0.5f);
+		const FBox LocalBox(Elem.Center - Extent, Elem.Center + Extent);
+		RasterizeBox(ToBox2D(LocalBox.TransformBy(Transform)), Elem.Rotation.IsNearlyZero());
+	}
+
+	// Anything that is not an axis aligned box is left to the engine
+	for (const FKConvexElem& Elem : AggGeom.ConvexElems)
+	{
+		RasterizeBox(ToBox2D(Elem.ElemBox.TransformBy(Transform)), false);
+	}
+
+	for (const FKSphereElem& Elem : AggGeom.SphereElems)
+	{
+		const FBox LocalBox(Elem.Center - FVector(Elem.Radius), Elem.Center + FVector(Elem.Radius));
+		RasterizeBox(ToBox2D(LocalBox.TransformBy(Transform)), false);
+	}
+
+	for (const FKSphylElem& Elem : AggGeom.SphylElems)
+	{
+		const FVector Extent(Elem.Radius + Elem.Length * 0.5f);
+		const FBox LocalBox(Elem.Center - Extent, Elem.Center + Extent);
+		RasterizeBox(ToBox2D(LocalBox.TransformBy(Transform)), false);
+	}
+
+	Exact = Partial;
+
+	return true;
+}
+
+FBox2D FRlCollisionGrid::GetCellsBox(int32 X0, int32 Y0, int32 X1, int32 Y1) const
+{
+	return FBox2D(FVector2D(Origin.X + X0 * CellSize, Origin.Y - (Y1 + 1) * CellSize), FVector2D(Origin.X + (X1 + 1) * CellSize, Origin.Y - Y0 * CellSize));
+}
+
+FArchive& operator<<(FArchive& Ar, FRlCollisionGrid& Grid)
+{
+	Ar << Grid.Origin;
+	Ar << Grid.CellSize;
+	Ar << Grid.Width;
+	Ar << Grid.Height;
+	Ar << Grid.Solid;
+	Ar << Grid.Partial;
+
+	if (Ar.IsLoading())
+	{
+		Grid.WordsPerRow = (Grid.Width + 63) / 64;
+		Grid.Exact = Grid.Partial;
+
+		if (Grid.Solid.Num() != Grid.WordsPerRow * Grid.Height || Grid.Partial.Num() != Grid.Solid.Num())
+		{
+			Ar.SetError();
+			Grid.Reset();
+		}
+	}
+
+	return Ar;
+}
+
+void FRlCollisionGrid::ResetHazards()
+{
+	// Same size on every reset, no allocation
+	Exact.SetNumUninitialized(Partial.Num(), false);
+	FMemory::Memcpy(Exact.GetData(), Partial.GetData(), Partial.Num() * sizeof(uint64));
+}
+
+void FRlCollisionGrid::AddHazard(const UPrimitiveComponent* HazardComponent)
+{
+	if (!IsValid() || !HazardComponent || !HazardComponent->IsCollisionEnabled())
+	{
+		return;
+	}
+
+	int32 X0, Y0, X1, Y1;
+	GetCells(ToBox2D(HazardComponent->Bounds.GetBox()), X0, Y0, X1, Y1);
+
+	for (int32 Y = Y0; Y <= Y1; ++Y)
+	{
+		for (int32 X = X0; X <= X1; ++X)
+		{
+			SetBit(Exact, X, Y);
+		}
+	}
+}
+
+void FRlCollisionGrid::AddDynamic(UPrimitiveComponent* DynamicComponent)
+{
+	DynamicComponents.AddUnique(DynamicComponent);
+}
+
+void FRlCollisionGrid::RemoveDynamic(UPrimitiveComponent* DynamicComponent)
+{
+	DynamicComponents.RemoveSwap(DynamicComponent);
+}
+
+ERlGridResult FRlCollisionGrid::Overlap(const FBox2D& Box, bool bIgnoreDynamic) const
+{
+	int32 X0, Y0, X1, Y1;
+	if (!IsValid() || !GetCells(Box, X0, Y0, X1, Y1) || (!bIgnoreDynamic && OverlapsDynamic(Box)))
+	{
+		return ERlGridResult::Unknown;
+	}
+
+	bool bBlocked = false;
+	for (int32 Y = Y0; Y <= Y1; ++Y)
+	{
+		if (AnyInRow(Exact, Y, X0, X1))
+		{
+			return ERlGridResult::Unknown;
+		}
+		bBlocked |= AnyInRow(Solid, Y, X0, X1);
+	}
+
+	return bBlocked ? ERlGridResult::Blocked : ERlGridResult::Clear;
+}
+
+ERlGridResult FRlCollisionGrid::SweepDown(const FBox2D& Box, float Distance, float& OutDistance) const
+{
+	const FBox2D SweptBox(FVector2D(Box.Min.X, Box.Min.Y - Distance), Box.Max);
+
+	int32 X0, Y0, X1, Y1;
+	int32 StartX0, StartY0, StartX1, StartY1;
+	if (!IsValid() || !GetCells(SweptBox, X0, Y0, X1, Y1) || !GetCells(Box, StartX0, StartY0, StartX1, StartY1) || OverlapsDynamic(SweptBox))
+	{
+		return ERlGridResult::Unknown;
+	}
+
+	// Rows go down, so the first solid row is the closest one
+	for (int32 Y = Y0; Y <= Y1; ++Y)
+	{
+		if (AnyInRow(Exact, Y, X0, X1))
+		{
+			return ERlGridResult::Unknown;
+		}
+
+		if (AnyInRow(Solid, Y, X0, X1))
+		{
+			// Started in penetration
+			if (Y <= StartY1)
+			{
+				return ERlGridResult::Unknown;
+			}
+
+			OutDistance = Box.Min.Y - (Origin.Y - Y * CellSize);
+			return ERlGridResult::Blocked;
+		}
+	}
+
+	return ERlGridResult::Clear;
+}
+
+bool FRlCollisionGrid::AnyInRow(const TArray<uint64>& Bits, int32 Y, int32 X0, int32 X1) const
+{
+	const uint64* Row = Bits.GetData() + Y * WordsPerRow;
+	const int32 Word0 = X0 >> 6;
+	const int32 Word1 = X1 >> 6;
+
+	for (int32 Word = Word0; Word <= Word1; ++Word)
+	{
+		uint64 Mask = ~0ull;
+		if (Word == Word0)
+		{
+			Mask &= ~0ull << (X0 & 63);
+		}
+		if (Word == Word1)
+		{
+			Mask &= ~0ull >> (63 - (X1 & 63));
+		}
+
+		if (Row[Word] & Mask)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FRlCollisionGrid::GetCells(const FBox2D& Box, int32& OutX0, int32& OutY0, int32& OutX1, int32& OutY1) const
+{
+	const float MinX = (Box.Min.X - Origin.X) / CellSize;
+	const float MaxX = (Box.Max.X - Origin.X) / CellSize;
+	const float MinY = (Origin.Y - Box.Max.Y) / CellSize;
+	const float MaxY = (Origin.Y - Box.Min.Y) / CellSize;
+
+	int32 X0 = FMath::FloorToInt(MinX + CellEdgeTolerance);
+	int32 X1 = FMath::Max(X0, FMath::FloorToInt(MaxX - CellEdgeTolerance));
+	int32 Y0 = FMath::FloorToInt(MinY + CellEdgeTolerance);
+	int32 Y1 = FMath::Max(Y0, FMath::FloorToInt(MaxY - CellEdgeTolerance));
+
+	const bool bInside = X0 >= 0 && Y0 >= 0 && X1 < Width && Y1 < Height;
+
+	OutX0 = FMath::Max(X0, 0);
+	OutY0 = FMath::Max(Y0, 0);
+	OutX1 = FMath::Min(X1, Width - 1);
+	OutY1 = FMath::Min(Y1, Height - 1);
+
+	return bInside;
+}
+
+void FRlCollisionGrid::RasterizeBox(const FBox2D& Box, bool bCanBeSolid)
+{
+	int32 X0, Y0, X1, Y1;
+	GetCells(Box, X0, Y0, X1, Y1);
+
+	const float Tolerance = CellSize * CellEdgeTolerance;
+
+	for (int32 Y = Y0; Y <= Y1; ++Y)
+	{
+		for (int32 X = X0; X <= X1; ++X)
+		{
+			const FVector2D CellMin(Origin.X + X * CellSize, Origin.Y - (Y + 1) * CellSize);
+			const FVector2D CellMax(CellMin.X + CellSize, CellMin.Y + CellSize);
+
+			const bool bCovered = bCanBeSolid
+				&& Box.Min.X <= CellMin.X + Tolerance && Box.Max.X >= CellMax.X - Tolerance
+				&& Box.Min.Y <= CellMin.Y + Tolerance && Box.Max.Y >= CellMax.Y - Tolerance;
+
+			SetBit(bCovered ? Solid : Partial, X, Y);
+		}
+	}
+}
+
+bool FRlCollisionGrid::OverlapsDynamic(const FBox2D& Box) const
+{
+	for (const TWeakObjectPtr<UPrimitiveComponent>& DynamicComponent : DynamicComponents)
+	{
+		if (DynamicComponent.IsValid() && DynamicComponent->IsCollisionEnabled() && ToBox2D(DynamicComponent->Bounds.GetBox()).Intersect(Box))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPaperTileMap;
+class UPaperTileMapComponent;
+class UPrimitiveComponent;
+
+/** Answer of a collision grid query. */
+enum class ERlGridResult : uint8
+{
+	/** Nothing blocks the queried area. */
+	Clear,
+	/** Only full solid tiles touch the queried area. */
+	Blocked,
+	/** Hazards, partial tiles, dynamic actors or the outside of the map touch the area, the engine has to answer. */
+	Unknown
+};
+
+/**
+ * Bit-packed occupancy of the current level tile map on the XZ plane, one bit per tile.
+ * Built from the tile map collision, so tiles fully covered by a box are solid and anything else with collision needs an exact test.
+ * Hazards and moving actors are also marked as needing an exact test, so the grid only ever replaces queries against plain solid tiles.
+ */
+struct RAGELITE_API FRlCollisionGrid
+{
+	FRlCollisionGrid();
+
+	/** Rasterizes the collision of the tile map component. Returns false if it has no collision. */
+	bool Build(UPaperTileMapComponent* TileMapComponent);
+
+	/** Rasterizes the collision of a tile map placed with the given transform, without a component. */
+	bool Build(const UPaperTileMap* TileMap, const FTransform& Transform);
+
+	void Reset();
+
+	bool IsValid() const { return Width > 0 && Height > 0; }
+
+	/** Clears the hazards, keeping the tile collision. */
+	void ResetHazards();
+
+	/** Marks every tile overlapped by the component bounds as needing an exact test. */
+	void AddHazard(const UPrimitiveComponent* Component);
+
+	/** Moving actors are tested against their current bounds on every query. */
+	void AddDynamic(UPrimitiveComponent* Component);
+
+	void RemoveDynamic(UPrimitiveComponent* Component);
+
+	/** Tests an XZ rectangle, X in the X of the box and Z in its Y. Moving actors are left out with bIgnoreDynamic. */
+	ERlGridResult Overlap(const FBox2D& Box, bool bIgnoreDynamic = false) const;
+
+	/**
+	 * Sweeps an XZ rectangle down by Distance.
+	 * On Blocked, OutDistance is the distance to the top of the first solid tile.
+	 * Unknown if the rectangle already overlaps something or the sweep touches anything but solid tiles.
+	 */
+	ERlGridResult SweepDown(const FBox2D& Box, float Distance, float& OutDistance) const;
+
+	/** Component holding the collision of the grid, reported as the hit component of grid queries. */
+	UPrimitiveComponent* GetComponent() const { return Component.Get(); }
+
+	void SetComponent(UPrimitiveComponent* InComponent) { Component = InComponent; }
+
+	int32 GetWidth() const { return Width; }
+
+	int32 GetHeight() const { return Height; }
+
+	bool IsSolid(int32 X, int32 Y) const { return !!(Solid[Y * WordsPerRow + (X >> 6)] & (1ull << (X & 63))); }
+
+	bool IsPartial(int32 X, int32 Y) const { return !!(Partial[Y * WordsPerRow + (X >> 6)] & (1ull << (X & 63))); }
+
+	/** XZ rectangle covered by the tiles from X0, Y0 to X1, Y1, all included. */
+	FBox2D GetCellsBox(int32 X0, int32 Y0, int32 X1, int32 Y1) const;
+
+	/** Serializes the tile collision, hazards and dynamic actors are not saved. */
+	friend FArchive& operator<<(FArchive& Ar, FRlCollisionGrid& Grid);
+
+private:
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** World X and Z of the top left corner of the grid. */
+	FVector2D Origin;
+
+	float CellSize;
+
+	int32 Width;
+
+	int32 Height;
+
+	int32 WordsPerRow;
+
+	/** Tiles fully covered by a collision box. */
+	TArray<uint64> Solid;
+
+	/** Tiles with any other collision. */
+	TArray<uint64> Partial;
+
+	/** Partial plus the hazards, the tiles that need an exact test. */
+	TArray<uint64> Exact;
+
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> DynamicComponents;
+
+	FORCEINLINE void SetBit(TArray<uint64>& Bits, int32 X, int32 Y)
+	{
+		Bits[Y * WordsPerRow + (X >> 6)] |= 1ull << (X & 63);
+	}
+
+	/** Whether any bit between columns X0 and X1, both included, is set in row Y. */
+	bool AnyInRow(const TArray<uint64>& Bits, int32 Y, int32 X0, int32 X1) const;
+
+	/** Columns and rows overlapped by the rectangle. Returns false if part of it is outside the grid. */
+	bool GetCells(const FBox2D& Box, int32& OutX0, int32& OutY0, int32& OutX1, int32& OutY1) const;
+
+	void RasterizeBox(const FBox2D& Box, bool bCanBeSolid);
+
+	bool OverlapsDynamic(const FBox2D& Box) const;
+};
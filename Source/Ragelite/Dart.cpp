@@ -3,10 +3,7 @@
 #include "Dart.h"
 #include "TimerManager.h"
 #include "Engine/World.h"
-#include "Projectile.h"
-#include "RlGameInstance.h"
-#include "LevelManager.h"
-#include "Paper2D/Classes/PaperSpriteComponent.h"
+#include "HazardPool.h"
 
 ADart::ADart()
 {
@@ -43,18 +40,21 @@ void ADart::Disable()
 	GetWorld()->GetTimerManager().ClearTimer(SpawnDartHandle);
 }
 
-void ADart::SpawnDart()
+void ADart::Restart()
 {
-	FRotator SpawnRotation(0.f);
-	FActorSpawnParameters SpawnInfo;
-
-	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
+	if (bEnabled)
+	{
+		Enable(Delay, Cooldown, Speed);
+	}
+}
 
-	AProjectile* Projectile = GetWorld()->SpawnActor<AProjectile>(GetActorLocation() + GetActorUpVector(), GetActorRotation(), SpawnInfo);
-	Projectile->InitialSpeed = Speed;
-	UPaperSpriteComponent* InRenderComponent = Projectile->GetRenderComponent();
-	InRenderComponent->SetSprite(LM->GetDartSprite());
-	InRenderComponent->SetMaterial(0, LM->Material);
+void ADart::SpawnDart()
+{
+	// Darts are spawned by the hazard pool, which also holds the projectiles
+	if (AHazardPool* HazardPool = Cast<AHazardPool>(GetOwner()))
+	{
+		HazardPool->FireProjectile(GetActorLocation() + GetActorUpVector(), GetActorRotation(), Speed);
+	}
 
 	GetWorld()->GetTimerManager().SetTimer(SpawnDartHandle, this, &ADart::SpawnDart, Cooldown, false);
 }
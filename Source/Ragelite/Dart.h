@@ -21,6 +21,9 @@ public:
 
 	void Disable();
 
+	/** Enables again with the last delay, cooldown and speed. */
+	void Restart();
+
 private:
 	UPROPERTY(EditAnywhere, Category = Dart, meta = (AllowPrivateAccess = "true"))
 	bool bEnabled;
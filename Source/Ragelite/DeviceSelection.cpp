@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "DeviceSelection.h"
+#include "Ragelite.h"
 #include "Components/ScrollBox.h"
 #include "Blueprint/WidgetTree.h"
 #include "Components/Button.h"
@@ -16,37 +17,25 @@
 #include "RlGameInstance.h"
 #include "RlGameMode.h"
 #include "WidgetManager.h"
+#include "BridgeProtocol.h"
+#include "Algo/BinarySearch.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogStatus, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("Device Selection AddDevice"), STAT_RlAddDevice, STATGROUP_Ragelite);
+DECLARE_CYCLE_STAT(TEXT("Device Selection RemoveDevice"), STAT_RlRemoveDevice, STATGROUP_Ragelite);
+
 UDeviceSelection::UDeviceSelection(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	AccumulatedTime = 0;
 	LastFocusedButton = nullptr;
+	NoDevicesButton = nullptr;
 	bPopUp = false;
 }
 
 void UDeviceSelection::NativeConstruct()
 {
-	UTextBlock* TextBlock = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
-	TextBlock->Text = FText::FromString("Meh");
-	UButton* Button = WidgetTree->ConstructWidget<UButton>(UButton::StaticClass());
-	Button->AddChild(TextBlock);
-	Devices->AddChild(Button);
-
-	UTextBlock* TextBlock2 = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
-	TextBlock2->Text = FText::FromString("Meh2");
-	UButton* Button2 = WidgetTree->ConstructWidget<UButton>(UButton::StaticClass());
-	Button2->AddChild(TextBlock2);
-	//Devices->AddChild(Button2);
-	InsertChildAt(Devices, 1, Button2);
-
-	//DevicesMap.Add(FString("aa:bb:cc"), 16);
-	//DevicesMap.Add(FString("aa:bb:dd"), 16);
-
-	Update();
-
-	//ClearDevices();
+	ClearDevices();
 
 	bTryingToConnect = false;
 
@@ -62,145 +51,79 @@ void UDeviceSelection::NativeConstruct()
 	Super::NativeConstruct();
 }
 
-void UDeviceSelection::Update()
+void UDeviceSelection::AddDevice(uint64 Address)
 {
-	if (!DevicesMap.Num())
-	{
-		if (Devices->GetChildrenCount() == 1)
-		{
-			UFocusButton* Button = Cast<UFocusButton>(Devices->GetChildAt(0));
-			if (Button && !Button->GetIsEnabled())
-			{
-				return;
-			}
-		}
-		while (Devices->HasAnyChildren())
-		{
-			Devices->RemoveChildAt(0);
-		}
-
-		AddDeviceButton(FString("No nearby devices"));
-
-		Cancel->SetIsEnabled(true);
-
-		LastFocusedButton = Cancel;
-		if (!bPopUp)
-		{
-			Cancel->SetKeyboardFocus();
-		}
+	SCOPE_CYCLE_COUNTER(STAT_RlAddDevice);
 
+	const int32 Index = Algo::LowerBoundBy(DeviceEntries, Address, [](const FRlDeviceEntry& Entry) { return Entry.Address; });
+	if (DeviceEntries.IsValidIndex(Index) && DeviceEntries[Index].Address == Address)
+	{
+		DeviceEntries[Index].Life = InitialLife;
 		return;
 	}
 
-	Cancel->SetIsEnabled(false);
+	UE_LOG(LogStatus, Log, TEXT("New device %s"), *RlBridge::AddressToString(Address));
 
-	if (Devices->HasAnyChildren())
-	{
-		UFocusButton* Button = Cast<UFocusButton>(Devices->GetChildAt(0));
-		if (Button && !Button->GetIsEnabled())
-		{
-			Devices->RemoveChildAt(0);
-		}
-	}
-
-	UFocusButton* FocusedButton = nullptr;
+	const bool bWasEmpty = !DeviceEntries.Num();
 
-	int32 CurrentIndex = 0;
+	FRlDeviceEntry Entry;
+	Entry.Address = Address;
+	Entry.Life = InitialLife;
+	Entry.Button = AcquireDeviceButton(Address);
+	DeviceEntries.Insert(Entry, Index);
 
-	for (auto It = DevicesMap.CreateConstIterator(); It;)
+	if (bWasEmpty)
 	{
-		auto Device = It.Key();
+		Devices->RemoveChild(NoDevicesButton);
+		Cancel->SetIsEnabled(false);
 
-		//if (DevicesArray.IsValidIndex(CurrentArrayIndex))
-		if (Devices->GetChildrenCount() > CurrentIndex)
-		{
-			bool bValidChildren = true;
-
-			UFocusButton* Button = Cast<UFocusButton>(Devices->GetChildAt(CurrentIndex));
-			if (Button && Button->GetChildrenCount() == 1)
-			{
-				UTextBlock* TextBlock = Cast<UTextBlock>(Button->GetChildAt(0));
-				if (TextBlock)
-				{
-					int32 Comparison = Device.Compare(TextBlock->Text.ToString());
-
-					if (!Comparison)
-					{
-						if (Button->HasKeyboardFocus() || (bPopUp && Button == LastFocusedButton))
-						{
-							FocusedButton = Button;
-						}
-
-						++It;
-						++CurrentIndex;
-						continue;
-					}
-					else if (Comparison > 0)
-					{
-						AddDeviceButton(Device, CurrentIndex++);
-						++It;
-						continue;
-					}
-					else
-					{
-						if ((Button->HasKeyboardFocus() || (bPopUp && Button == LastFocusedButton)) && CurrentIndex)
-						{
-							FocusedButton = Cast<UFocusButton>(Devices->GetChildAt(CurrentIndex - 1));
-						}
-					}
-				}
-			}
-
-			Devices->RemoveChildAt(CurrentIndex);
-		}
-		else
+		LastFocusedButton = Entry.Button;
+		if (!bPopUp)
 		{
-			AddDeviceButton(Device);
-			++It;
-			++CurrentIndex;
+			Entry.Button->SetKeyboardFocus();
 		}
 	}
+}
 
-	while (Devices->GetChildrenCount() > CurrentIndex)
-	{
-		Devices->RemoveChildAt(CurrentIndex);
-	}
-
-	// Rebuild UI
-	auto Children = Devices->GetAllChildren();
+void UDeviceSelection::RemoveDevice(int32 EntryIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RlRemoveDevice);
 
-	while (Devices->HasAnyChildren())
-	{
-		Devices->RemoveChildAt(0);
-	}
+	UFocusButton* Button = DeviceEntries[EntryIndex].Button;
+	const bool bFocused = Button->HasKeyboardFocus() || Button == LastFocusedButton;
+	const int32 ChildIndex = Devices->GetChildIndex(Button);
 
-	for (auto& Child : Children)
-	{
-		Devices->AddChild(Child);
-	}
+	Devices->RemoveChild(Button);
+	FreeButtons.Add(Button);
+	DeviceEntries.RemoveAt(EntryIndex, 1, false);
 
-	if (!FocusedButton)
+	// Focus goes to the button before, or the new first one
+	if (bFocused && DeviceEntries.Num())
 	{
-		FocusedButton = Cast<UFocusButton>(Devices->GetChildAt(0));
-	}
-
-	LastFocusedButton = FocusedButton;
-	if (!bPopUp)
-	{
-		FocusedButton->SetKeyboardFocus();
+		LastFocusedButton = Cast<UFocusButton>(Devices->GetChildAt(FMath::Max(ChildIndex - 1, 0)));
+		if (LastFocusedButton && !bPopUp)
+		{
+			LastFocusedButton->SetKeyboardFocus();
+		}
 	}
 }
 
-void UDeviceSelection::AddDevice(FString Device)
+void UDeviceSelection::UpdateEmpty()
 {
-	if (DevicesMap.Contains(Device))
+	if (DeviceEntries.Num() || Devices->HasChild(NoDevicesButton))
 	{
-		DevicesMap[Device] = InitialLife;
 		return;
 	}
-	DevicesMap.Add(Device, InitialLife);
 
-	Update();
+	Devices->AddChild(NoDevicesButton);
+
+	Cancel->SetIsEnabled(true);
+
+	LastFocusedButton = Cancel;
+	if (!bPopUp)
+	{
+		Cancel->SetKeyboardFocus();
+	}
 }
 
 void UDeviceSelection::DeviceConnectionFailed()
@@ -234,109 +157,83 @@ void UDeviceSelection::NativeTick(const FGeometry& MyGeometry, float InDeltaTime
 	{
 		AccumulatedTime = 0;
 
-		bool bUpdate = false;
-
-		TArray<FString> DevicesToRemove;
-
-		for (auto& Device : DevicesMap)
+		// Backwards, so removing keeps the indices still to visit
+		for (int32 i = DeviceEntries.Num() - 1; i >= 0; --i)
 		{
-			if (!--DevicesMap[Device.Key])
+			if (!--DeviceEntries[i].Life)
 			{
-				DevicesToRemove.Add(Device.Key);
-				bUpdate = true;
+				RemoveDevice(i);
 			}
 		}
 
-		for (auto& Device : DevicesToRemove)
-		{
-			DevicesMap.Remove(Device);
-		}
-
-		if (bUpdate)
-		{
-			Update();
-		}
+		UpdateEmpty();
 	}
 }
 
-void UDeviceSelection::AddDeviceButton(FString Device, int32 Index /*= -1*/)
+UFocusButton* UDeviceSelection::AcquireDeviceButton(uint64 Address)
 {
-	//UWidgetManager* WM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->WidgetManager;
-
-	UFocusButton* Button = WidgetTree->ConstructWidget<UFocusButton>(UFocusButton::StaticClass());
-	UTextBlock* TextBlock = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
-
-	TextBlock->Text = FText::FromString(Device);
-	Button->AddChild(TextBlock);
-
-	if (!DevicesMap.Num())
-	{
-		Button->SetIsEnabled(false);
-	}
-	else
+	UFocusButton* Button = FreeButtons.Num() ? FreeButtons.Pop(false) : nullptr;
+	if (!Button)
 	{
+		Button = WidgetTree->ConstructWidget<UFocusButton>(UFocusButton::StaticClass());
+		Button->AddChild(WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass()));
 		Button->OnClickDelegate.AddDynamic(this, &UDeviceSelection::OnButtonClicked);
 	}
 
-	if (Index == -1)
-	{
-		Devices->AddChild(Button);
-	}
-	else
+	if (UTextBlock* TextBlock = Cast<UTextBlock>(Button->GetChildAt(0)))
 	{
-		InsertChildAt(Devices, Index, Button);
+		TextBlock->SetText(FText::FromString(RlBridge::AddressToString(Address)));
 	}
+
+	Devices->AddChild(Button);
+
+	return Button;
 }
 
 void UDeviceSelection::ClearDevices()
 {
-	while (Devices->HasAnyChildren())
+	for (int32 i = DeviceEntries.Num() - 1; i >= 0; --i)
 	{
-		Devices->RemoveChildAt(0);
+		RemoveDevice(i);
 	}
+	Devices->ClearChildren();
 
-	AddDeviceButton(FString("No nearby devices"));
+	if (!NoDevicesButton)
+	{
+		NoDevicesButton = WidgetTree->ConstructWidget<UFocusButton>(UFocusButton::StaticClass());
+		UTextBlock* TextBlock = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass());
+		TextBlock->SetText(FText::FromString(FString("No nearby devices")));
+		NoDevicesButton->AddChild(TextBlock);
+		NoDevicesButton->SetIsEnabled(false);
+	}
 
-	Cancel->SetIsEnabled(true);
+	UpdateEmpty();
 }
 
 void UDeviceSelection::OnButtonClicked(UFocusButton* Button)
 {
-	if (Button && Button->GetChildrenCount() == 1)
+	const FRlDeviceEntry* Entry = DeviceEntries.FindByPredicate([Button](const FRlDeviceEntry& Candidate) { return Candidate.Button == Button; });
+	if (!Entry)
 	{
-		UTextBlock* TextBlock = Cast<UTextBlock>(Button->GetChildAt(0));
-		if (TextBlock)
-		{
-			//ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
-			//if (LM->DeviceSelection && !LM->DeviceSelection->bTryingToConnect)
-			if (!bTryingToConnect)
-			{
-				bTryingToConnect = true;
-				ARlCharacter* RlCharacter = Cast<ARlCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
-
-				// TODO Reply with a confirmation of the conection or try again
-				RlCharacter->Connect(TextBlock->Text.ToString());
-
-				Connecting->SetVisibility(ESlateVisibility::SelfHitTestInvisible);
-
-				auto PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-				PC->SetInputMode(FInputModeGameOnly());
-				UGameplayStatics::GetPlayerPawn(GetWorld(), 0)->DisableInput(PC);
-			}
-		}
+		return;
 	}
-}
 
-void UDeviceSelection::InsertChildAt(UPanelWidget* Widget, int32 Index, UWidget* Content)
-{
-	UPanelSlot* NewSlot = Widget->AddChild(Content);
+	//ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
+	//if (LM->DeviceSelection && !LM->DeviceSelection->bTryingToConnect)
+	if (!bTryingToConnect)
+	{
+		bTryingToConnect = true;
+		ARlCharacter* RlCharacter = Cast<ARlCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
 
-	int32 CurrentIndex = Widget->GetChildIndex(Content);
+		// TODO Reply with a confirmation of the conection or try again
+		RlCharacter->Connect(RlBridge::AddressToString(Entry->Address));
 
-	TArray<UPanelSlot*> Slots = Widget->GetSlots();
+		Connecting->SetVisibility(ESlateVisibility::SelfHitTestInvisible);
 
-	Slots.RemoveAt(CurrentIndex);
-	Slots.Insert(Content->Slot, FMath::Clamp(Index, 0, Slots.Num()));
+		auto PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+		PC->SetInputMode(FInputModeGameOnly());
+		UGameplayStatics::GetPlayerPawn(GetWorld(), 0)->DisableInput(PC);
+	}
 }
 
 void UDeviceSelection::OnCancel()
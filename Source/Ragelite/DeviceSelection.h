@@ -12,8 +12,21 @@ class UFocusButton;
 class UCanvasPanel;
 class UPanelWidget;
 
+/** A nearby device of the device list. */
+struct FRlDeviceEntry
+{
+	/** MAC address packed in the low 48 bits. */
+	uint64 Address;
+
+	/** Seconds left without an advert before the device is removed. */
+	uint8 Life;
+
+	UFocusButton* Button;
+};
+
 /**
- * 
+ * List of the nearby devices, one button per device kept for as long as the device advertises.
+ * Buttons stay where they were added, a new device is appended and a silent one removed, the rest of the list never moves.
  */
 UCLASS()
 class RAGELITE_API UDeviceSelection : public UUserWidget
@@ -48,10 +61,8 @@ public:
 
 	FTimerHandle FailedHandle;
 
-	void Update();
-
-
-	void AddDevice(FString Device);
+	/** Refreshes the life of a known device or adds a button for a new one. */
+	void AddDevice(uint64 Address);
 
 	bool bTryingToConnect;
 
@@ -64,22 +75,33 @@ protected:
 	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
 
 private:
-	// MAC and life of the device
-	TSortedMap<FString, uint8> DevicesMap;
+	/** Sorted by address. */
+	TArray<FRlDeviceEntry> DeviceEntries;
+
+	/** Buttons of removed devices, reused for the next ones. */
+	UPROPERTY()
+	TArray<UFocusButton*> FreeButtons;
+
+	/** Disabled button shown while there are no devices. */
+	UPROPERTY()
+	UFocusButton* NoDevicesButton;
 
 	float AccumulatedTime;
 
 	uint8 InitialLife = 30;
 
-	void AddDeviceButton(FString Device, int32 Index = -1);
+	UFocusButton* AcquireDeviceButton(uint64 Address);
+
+	void RemoveDevice(int32 EntryIndex);
+
+	/** Shows the no devices button and focuses cancel if the list is empty. */
+	void UpdateEmpty();
 
 	void ClearDevices();
 
 	UFUNCTION()
 	void OnButtonClicked(UFocusButton* Button);
 
-	void InsertChildAt(UPanelWidget* Widget, int32 Index, UWidget* Content);
-
 	UFUNCTION()
 	void OnCancel();
 
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FrameTimeOverlay.h"
+#include "Containers/Ticker.h"
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogFrameTime, Log, All);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarFrameTimeOverlay(
+		TEXT("rl.FrameTimeOverlay"),
+		0,
+		TEXT("Draws the rolling p50 and p99 frame time and the hitches over the game view."));
+
+	TAutoConsoleVariable<float> CVarHitchBudgetMs(
+		TEXT("rl.HitchBudgetMs"),
+		1000.f / 30.f,
+		TEXT("Frames longer than this, in milliseconds, are hitches."));
+
+	/** Time a hitch stays highlighted in the overlay. */
+	const double HitchHighlightTime = 2.0;
+}
+
+FRlFrameTimeOverlay::FRlFrameTimeOverlay(int32 InWindowSize)
+	: NextFrame(0)
+	, NumFrames(0)
+	, NumHitches(0)
+	, WorstHitch(0.f)
+	, LastHitchTime(-HitchHighlightTime)
+{
+	FrameTimes.SetNumZeroed(FMath::Max(InWindowSize, 1));
+	SortedFrameTimes.Reserve(FrameTimes.Num());
+
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FRlFrameTimeOverlay::Tick));
+	DrawHandle = UDebugDrawService::Register(TEXT("Game"), FDebugDrawDelegate::CreateRaw(this, &FRlFrameTimeOverlay::Draw));
+}
+
+FRlFrameTimeOverlay::~FRlFrameTimeOverlay()
+{
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	UDebugDrawService::Unregister(DrawHandle);
+}
+
+bool FRlFrameTimeOverlay::Tick(float DeltaTime)
+{
+	const float FrameTime = DeltaTime * 1000.f;
+
+	FrameTimes[NextFrame] = FrameTime;
+	NextFrame = (NextFrame + 1) % FrameTimes.Num();
+	NumFrames = FMath::Min(NumFrames + 1, FrameTimes.Num());
+
+	const float Budget = CVarHitchBudgetMs.GetValueOnGameThread();
+	if (Budget > 0.f && FrameTime > Budget)
+	{
+		NumHitches++;
+		WorstHitch = FMath::Max(WorstHitch, FrameTime);
+		LastHitchTime = FPlatformTime::Seconds();
+		UE_LOG(LogFrameTime, Log, TEXT("Hitch: %.1f ms, budget %.1f ms"), FrameTime, Budget);
+	}
+
+	return true;
+}
+
+float FRlFrameTimeOverlay::GetPercentile(float Percentile)
+{
+	if (!NumFrames)
+	{
+		return 0.f;
+	}
+
+	SortedFrameTimes.Reset();
+	SortedFrameTimes.Append(FrameTimes.GetData(), NumFrames);
+	SortedFrameTimes.Sort();
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * NumFrames) - 1, 0, NumFrames - 1);
+	return SortedFrameTimes[Index];
+}
+
+void FRlFrameTimeOverlay::Draw(UCanvas* Canvas, APlayerController* PlayerController)
+{
+	if (!CVarFrameTimeOverlay.GetValueOnGameThread() || !Canvas)
+	{
+		return;
+	}
+
+	const float Budget = CVarHitchBudgetMs.GetValueOnGameThread();
+	const float P50 = GetPercentile(0.5f);
+	const float P99 = GetPercentile(0.99f);
+	const double SinceHitch = FPlatformTime::Seconds() - LastHitchTime;
+
+	UFont* Font = GEngine->GetSmallFont();
+	const float X = 16.f;
+	float Y = 16.f;
+
+	Canvas->SetDrawColor(P99 > Budget ? FColor::Yellow : FColor::Green);
+	Y += Canvas->DrawText(Font, FString::Printf(TEXT("Frame p50 %.1f ms  p99 %.1f ms  (%i frames)"), P50, P99, NumFrames), X, Y);
+
+	Canvas->SetDrawColor(SinceHitch < HitchHighlightTime ? FColor::Red : FColor::White);
+	if (NumHitches)
+	{
+		Canvas->DrawText(Font, FString::Printf(TEXT("Hitches over %.1f ms: %u  worst %.1f ms  last %.1f s ago"), Budget, NumHitches, WorstHitch, SinceHitch), X, Y);
+	}
+	else
+	{
+		Canvas->DrawText(Font, FString::Printf(TEXT("No hitches over %.1f ms"), Budget), X, Y);
+	}
+}
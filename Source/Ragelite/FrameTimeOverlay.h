@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCanvas;
+class APlayerController;
+
+/**
+ * Keeps the frame times of the last few seconds and counts the hitches, frames over the budget (rl.HitchBudgetMs).
+ * With rl.FrameTimeOverlay 1, draws the rolling p50 and p99 and the hitches over the game view.
+ * Hitches are logged either way, so a stall on the show floor can be found in the log afterwards.
+ */
+class RAGELITE_API FRlFrameTimeOverlay
+{
+public:
+	FRlFrameTimeOverlay(int32 InWindowSize = 300);
+
+	~FRlFrameTimeOverlay();
+
+	/** Percentile in [0, 1] of the frame times in the window, in milliseconds. */
+	float GetPercentile(float Percentile);
+
+private:
+	/** Ring buffer of frame times in milliseconds. */
+	TArray<float> FrameTimes;
+
+	int32 NextFrame;
+
+	int32 NumFrames;
+
+	/** Copy of the window sorted for the percentiles, kept to reuse the allocation. */
+	TArray<float> SortedFrameTimes;
+
+	uint32 NumHitches;
+
+	float WorstHitch;
+
+	double LastHitchTime;
+
+	FDelegateHandle TickerHandle;
+
+	FDelegateHandle DrawHandle;
+
+	bool Tick(float DeltaTime);
+
+	void Draw(UCanvas* Canvas, APlayerController* PlayerController);
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Ghost.h"
+#include "Paper2D/Classes/PaperFlipbookComponent.h"
+
+AGhost::AGhost()
+{
+	UPaperFlipbookComponent* InRenderComponent = GetRenderComponent();
+
+	InRenderComponent->SetMobility(EComponentMobility::Movable);
+	InRenderComponent->SetCollisionProfileName(FName("NoCollision"));
+	InRenderComponent->SetGenerateOverlapEvents(false);
+	InRenderComponent->CastShadow = false;
+
+	// Frames come from the samples, the component never plays
+	InRenderComponent->PrimaryComponentTick.bCanEverTick = false;
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AGhost::SetAnimation(UPaperFlipbook* Flipbook, int32 Frame)
+{
+	UPaperFlipbookComponent* InRenderComponent = GetRenderComponent();
+
+	if (InRenderComponent->GetFlipbook() != Flipbook)
+	{
+		InRenderComponent->SetFlipbook(Flipbook);
+	}
+
+	if (InRenderComponent->GetPlaybackPositionInFrames() != Frame)
+	{
+		InRenderComponent->SetPlaybackPositionInFrames(Frame, false);
+	}
+}
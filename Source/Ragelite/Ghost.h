@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PaperFlipbookActor.h"
+#include "Ghost.generated.h"
+
+/**
+ * A past level attempt drawn next to the character, only a flipbook without collision, movement or tick.
+ * AGhostManager moves it and sets its flipbook from the recorded samples.
+ */
+UCLASS()
+class RAGELITE_API AGhost : public APaperFlipbookActor
+{
+	GENERATED_BODY()
+
+public:
+	AGhost();
+
+	/** Shows a frame of a flipbook, only touching the component when the flipbook or the frame changed. */
+	void SetAnimation(UPaperFlipbook* Flipbook, int32 Frame);
+};
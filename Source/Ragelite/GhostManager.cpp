@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GhostManager.h"
+#include "Ragelite.h"
+#include "Ghost.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Materials/MaterialInterface.h"
+#include "ConstructorHelpers.h"
+#include "Paper2D/Classes/PaperFlipbookComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGhosts, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Ghost Manager Tick"), STAT_RlGhostManagerTick, STATGROUP_Ragelite);
+
+AGhostManager::AGhostManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Opacity = 0.3f;
+	DepthOffset = 1.f;
+
+	static ConstructorHelpers::FObjectFinder<UMaterialInterface> MaterialRef(TEXT("/Paper2D/TranslucentUnlitSpriteMaterial"));
+	Material = MaterialRef.Object;
+
+	Time = 0.f;
+
+	FMemory::Memzero(Flipbooks);
+}
+
+void AGhostManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	Pool.Init(this);
+	Pool.OnSpawned = [this](AGhost* Ghost)
+	{
+		UPaperFlipbookComponent* RenderComponent = Ghost->GetRenderComponent();
+		if (Material)
+		{
+			RenderComponent->SetMaterial(0, Material);
+		}
+		RenderComponent->SetSpriteColor(FLinearColor(1.f, 1.f, 1.f, Opacity));
+	};
+}
+
+void AGhostManager::LoadRuns(int32 MaxGhosts)
+{
+	RunFiles.Reset();
+	TracksByLevel.Reset();
+
+	const FString Directory = FRlGhostRecorder::GetDirectory();
+
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles(Filenames, *(Directory / TEXT("*.rlgh")), true, false);
+
+	// Named after their start time, so newest first
+	Filenames.Sort(TGreater<FString>());
+
+	int32 NumTracks = 0;
+	int32 MaxTracks = 0;
+
+	for (const FString& Filename : Filenames)
+	{
+		TUniquePtr<FRlGhostRunFile> RunFile = MakeUnique<FRlGhostRunFile>();
+		if (!RunFile->Open(Directory / Filename))
+		{
+			// Also the run being recorded, its segments are only written when it ends
+			continue;
+		}
+
+		bool bUsed = false;
+		for (const FRlGhostSegment& Segment : RunFile->GetSegments())
+		{
+			if (Segment.LevelIndex < 0 || Segment.NumSamples < 2)
+			{
+				continue;
+			}
+
+			if (TracksByLevel.Num() <= Segment.LevelIndex)
+			{
+				TracksByLevel.SetNum(Segment.LevelIndex + 1);
+			}
+
+			TArray<FRlGhostTrack>& Tracks = TracksByLevel[Segment.LevelIndex];
+			if (Tracks.Num() < MaxGhosts)
+			{
+				Tracks.Add({ RunFile->GetSamples(Segment), Segment.NumSamples, RunFile->GetSampleRate() });
+				MaxTracks = FMath::Max(MaxTracks, Tracks.Num());
+				NumTracks++;
+				bUsed = true;
+			}
+		}
+
+		if (bUsed)
+		{
+			RunFiles.Add(MoveTemp(RunFile));
+		}
+	}
+
+	UE_LOG(LogGhosts, Log, TEXT("Loaded %i level attempts from %i run files"), NumTracks, RunFiles.Num());
+
+	// Enough ghosts for the busiest level, so starting a level spawns nothing
+	Pool.Prewarm(MaxTracks);
+}
+
+void AGhostManager::StartLevel(int32 LevelIndex)
+{
+	Pool.ReleaseAll();
+	ActiveTracks.Reset();
+	ActiveGhosts.Reset();
+	Time = 0.f;
+
+	if (!TracksByLevel.IsValidIndex(LevelIndex))
+	{
+		return;
+	}
+
+	UpdateFlipbooks();
+
+	for (const FRlGhostTrack& Track : TracksByLevel[LevelIndex])
+	{
+		const FRlGhostSample& Sample = Track.Samples[0];
+		ActiveTracks.Add(Track);
+		ActiveGhosts.Add(Pool.Acquire(FVector(Sample.X, Sample.Y + DepthOffset, Sample.Z), FRotator(0.f)));
+	}
+}
+
+void AGhostManager::UpdateFlipbooks()
+{
+	const ARlCharacter* RlCharacter = Cast<ARlCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+	if (!RlCharacter)
+	{
+		return;
+	}
+
+	for (int32 State = 0; State < (int32)ERlAnimationState::Num; ++State)
+	{
+		for (int32 Flags = 0; Flags < 4; ++Flags)
+		{
+			const bool bRight = EnumHasAnyFlags((ERlGhostFlags)Flags, ERlGhostFlags::FacingRight);
+			const bool bWallWalking = EnumHasAnyFlags((ERlGhostFlags)Flags, ERlGhostFlags::WallWalking);
+			Flipbooks[State][Flags] = RlCharacter->GetStateFlipbook((ERlAnimationState)State, bRight, bWallWalking);
+		}
+	}
+}
+
+void AGhostManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RlGhostManagerTick);
+
+	Super::Tick(DeltaSeconds);
+
+	if (!ActiveTracks.Num())
+	{
+		return;
+	}
+
+	Time += DeltaSeconds;
+
+	for (int32 i = ActiveTracks.Num() - 1; i >= 0; --i)
+	{
+		const FRlGhostTrack& Track = ActiveTracks[i];
+		AGhost* Ghost = ActiveGhosts[i];
+
+		const float Position = Time * Track.SampleRate;
+		const int32 Index = FMath::FloorToInt(Position);
+
+		// The attempt ended, the ghost leaves until the level restarts
+		if (Index >= Track.NumSamples - 1)
+		{
+			Pool.Release(Ghost);
+			ActiveTracks.RemoveAtSwap(i, 1, false);
+			ActiveGhosts.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		const FRlGhostSample& From = Track.Samples[Index];
+		const FRlGhostSample& To = Track.Samples[Index + 1];
+		const float Alpha = Position - Index;
+
+		const FVector Location(FMath::Lerp(From.X, To.X, Alpha), FMath::Lerp(From.Y, To.Y, Alpha) + DepthOffset, FMath::Lerp(From.Z, To.Z, Alpha));
+		Ghost->SetActorLocation(Location);
+
+		Ghost->SetActorHiddenInGame(EnumHasAnyFlags(From.Flags, ERlGhostFlags::Hidden));
+
+		if (From.State < (uint8)ERlAnimationState::Num)
+		{
+			const uint8 Flags = (uint8)(From.Flags & (ERlGhostFlags::FacingRight | ERlGhostFlags::WallWalking));
+			Ghost->SetAnimation(Flipbooks[From.State][Flags], From.Frame);
+		}
+	}
+}
+
+void AGhostManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	Pool.DestroyAll();
+
+	ActiveTracks.Reset();
+	ActiveGhosts.Reset();
+	TracksByLevel.Reset();
+
+	// The tracks point into the files
+	RunFiles.Reset();
+}
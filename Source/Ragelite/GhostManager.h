@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ActorPool.h"
+#include "RlCharacter.h"
+#include "GhostRun.h"
+#include "GhostManager.generated.h"
+
+class AGhost;
+class UPaperFlipbook;
+class UMaterialInterface;
+
+/** Samples of one recorded level attempt, read in place from a mapped run file. */
+struct FRlGhostTrack
+{
+	const FRlGhostSample* Samples;
+
+	int32 NumSamples;
+
+	float SampleRate;
+};
+
+/**
+ * Plays past level attempts as ghosts next to the character.
+ * Run files are mapped once, and every ghost of the level is moved in a single tick by interpolating its samples,
+ * so dozens of attempts cost a flipbook each and no simulation.
+ */
+UCLASS()
+class RAGELITE_API AGhostManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGhostManager();
+
+	/** Alpha of the ghost sprites. */
+	UPROPERTY(EditAnywhere, Category = Ghosts)
+	float Opacity;
+
+	/** Added to the recorded Y, so ghosts are drawn behind the character. */
+	UPROPERTY(EditAnywhere, Category = Ghosts)
+	float DepthOffset;
+
+	/** Translucent, so the sprite color alpha applies. */
+	UPROPERTY(EditAnywhere, Category = Ghosts)
+	UMaterialInterface* Material;
+
+	TRlActorPool<AGhost> Pool;
+
+	/** Maps the run files of past sessions, newest first, keeping up to MaxGhosts attempts per level. */
+	void LoadRuns(int32 MaxGhosts);
+
+	/** Restarts the ghosts with the attempts of a level, called whenever the level (re)starts. */
+	void StartLevel(int32 LevelIndex);
+
+	virtual void PostInitializeComponents() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	TArray<TUniquePtr<FRlGhostRunFile>> RunFiles;
+
+	TArray<TArray<FRlGhostTrack>> TracksByLevel;
+
+	// One entry per ghost playing
+
+	TArray<FRlGhostTrack> ActiveTracks;
+
+	TArray<AGhost*> ActiveGhosts;
+
+	/** Time since the level started. */
+	float Time;
+
+	/** Flipbook of every recorded state, facing and wall walking, taken from the character when a level starts. */
+	UPaperFlipbook* Flipbooks[(int32)ERlAnimationState::Num][4];
+
+	void UpdateFlipbooks();
+};
@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GhostRun.h"
+#include "RlCharacter.h"
+#include "RlCharacterMovementComponent.h"
+#include "HAL/FileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Paper2D/Classes/PaperFlipbookComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGhostRun, Log, All);
+
+FRlGhostRecorder::FRlGhostRecorder(const FString& InFilename, float InSampleRate)
+	: Filename(InFilename)
+	, Writer(nullptr)
+	, SampleRate(InSampleRate)
+	, Accumulator(0.f)
+{
+	Writer = IFileManager::Get().CreateFileWriter(*Filename);
+	if (!Writer)
+	{
+		UE_LOG(LogGhostRun, Warning, TEXT("Could not create run file %s"), *Filename);
+		return;
+	}
+
+	// Without segments until closed, so a run cut short is never played
+	FRlGhostFileHeader Header;
+	Header.FileMagic = FRlGhostFileHeader::Magic;
+	Header.FileVersion = FRlGhostFileHeader::Version;
+	Header.SampleRate = SampleRate;
+	Header.NumSegments = 0;
+	Header.SegmentsOffset = 0;
+	Writer->Serialize(&Header, sizeof(Header));
+}
+
+FRlGhostRecorder::~FRlGhostRecorder()
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	FRlGhostFileHeader Header;
+	Header.FileMagic = FRlGhostFileHeader::Magic;
+	Header.FileVersion = FRlGhostFileHeader::Version;
+	Header.SampleRate = SampleRate;
+	Header.NumSegments = Segments.Num();
+	Header.SegmentsOffset = Writer->Tell();
+
+	Writer->Serialize(Segments.GetData(), Segments.Num() * sizeof(FRlGhostSegment));
+	Writer->Seek(0);
+	Writer->Serialize(&Header, sizeof(Header));
+
+	const bool bSaved = Writer->Close();
+	delete Writer;
+	Writer = nullptr;
+
+	if (bSaved)
+	{
+		UE_LOG(LogGhostRun, Log, TEXT("Run saved to %s: %i level attempts"), *Filename, Segments.Num());
+	}
+	else
+	{
+		UE_LOG(LogGhostRun, Warning, TEXT("Could not save run file %s"), *Filename);
+	}
+}
+
+FString FRlGhostRecorder::GetDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Ghosts");
+}
+
+void FRlGhostRecorder::BeginSegment(int32 LevelIndex)
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	FRlGhostSegment& Segment = Segments.AddDefaulted_GetRef();
+	Segment.LevelIndex = LevelIndex;
+	Segment.NumSamples = 0;
+	Segment.SamplesOffset = Writer->Tell();
+
+	// The first tick of the attempt writes the first sample
+	Accumulator = 1.f / SampleRate;
+}
+
+void FRlGhostRecorder::Record(const ARlCharacter* Character, float DeltaTime)
+{
+	if (!Writer || !Segments.Num())
+	{
+		return;
+	}
+
+	const float Interval = 1.f / SampleRate;
+	Accumulator += DeltaTime;
+	if (Accumulator < Interval)
+	{
+		return;
+	}
+
+	const FVector Location = Character->GetActorLocation();
+	const UPaperFlipbookComponent* Sprite = Character->GetSprite();
+
+	FRlGhostSample Sample;
+	Sample.X = Location.X;
+	Sample.Y = Location.Y;
+	Sample.Z = Location.Z;
+	Sample.State = (uint8)Character->GetAnimationState();
+	Sample.Flags = ERlGhostFlags::None;
+	Sample.Frame = (uint16)FMath::Clamp(Sprite->GetPlaybackPositionInFrames(), 0, (int32)MAX_uint16);
+
+	if (Character->bIsLastDirectionRight)
+	{
+		Sample.Flags |= ERlGhostFlags::FacingRight;
+	}
+	if (Character->GetRlCharacterMovement()->IsWallWalking())
+	{
+		Sample.Flags |= ERlGhostFlags::WallWalking;
+	}
+	if (!Sprite->IsVisible())
+	{
+		Sample.Flags |= ERlGhostFlags::Hidden;
+	}
+
+	// A long frame repeats the sample, so the samples stay on a fixed clock
+	FRlGhostSegment& Segment = Segments.Last();
+	while (Accumulator >= Interval)
+	{
+		Writer->Serialize(&Sample, sizeof(Sample));
+		Segment.NumSamples++;
+		Accumulator -= Interval;
+	}
+}
+
+FRlGhostRunFile::FRlGhostRunFile()
+	: MappedHandle(nullptr)
+	, MappedRegion(nullptr)
+	, Base(nullptr)
+	, Size(0)
+	, Header(nullptr)
+{
+}
+
+FRlGhostRunFile::~FRlGhostRunFile()
+{
+	Close();
+}
+
+bool FRlGhostRunFile::Open(const FString& Filename)
+{
+	Close();
+
+	MappedHandle = IPlatformFile::GetPlatformPhysical().OpenMapped(*Filename);
+	if (MappedHandle)
+	{
+		MappedRegion = MappedHandle->MapRegion();
+	}
+
+	if (MappedRegion)
+	{
+		Base = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		UE_LOG(LogGhostRun, Verbose, TEXT("Could not map %s, loading it"), *Filename);
+
+		if (!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+		{
+			Close();
+			return false;
+		}
+		Base = Data.GetData();
+		Size = Data.Num();
+	}
+
+	if (Size < (int64)sizeof(FRlGhostFileHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const FRlGhostFileHeader* FileHeader = (const FRlGhostFileHeader*)Base;
+	if (FileHeader->FileMagic != FRlGhostFileHeader::Magic || FileHeader->FileVersion != FRlGhostFileHeader::Version
+		|| FileHeader->SampleRate <= 0.f || FileHeader->NumSegments <= 0
+		|| FileHeader->SegmentsOffset < (int64)sizeof(FRlGhostFileHeader) || FileHeader->SegmentsOffset + FileHeader->NumSegments * (int64)sizeof(FRlGhostSegment) > Size)
+	{
+		Close();
+		return false;
+	}
+
+	Header = FileHeader;
+
+	for (const FRlGhostSegment& Segment : GetSegments())
+	{
+		if (Segment.NumSamples < 0 || Segment.SamplesOffset < (int64)sizeof(FRlGhostFileHeader) || Segment.SamplesOffset + Segment.NumSamples * (int64)sizeof(FRlGhostSample) > Header->SegmentsOffset)
+		{
+			UE_LOG(LogGhostRun, Warning, TEXT("%s has an invalid segment"), *Filename);
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FRlGhostRunFile::Close()
+{
+	Header = nullptr;
+	Base = nullptr;
+	Size = 0;
+	Data.Empty();
+
+	// The region has to go before its file
+	delete MappedRegion;
+	MappedRegion = nullptr;
+	delete MappedHandle;
+	MappedHandle = nullptr;
+}
+
+TArrayView<const FRlGhostSegment> FRlGhostRunFile::GetSegments() const
+{
+	if (!Header)
+	{
+		return TArrayView<const FRlGhostSegment>();
+	}
+	return TArrayView<const FRlGhostSegment>((const FRlGhostSegment*)(Base + Header->SegmentsOffset), Header->NumSegments);
+}
+
+const FRlGhostSample* FRlGhostRunFile::GetSamples(const FRlGhostSegment& Segment) const
+{
+	return (const FRlGhostSample*)(Base + Segment.SamplesOffset);
+}
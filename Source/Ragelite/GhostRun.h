@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FArchive;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class ARlCharacter;
+
+enum class ERlGhostFlags : uint8
+{
+	None = 0,
+	FacingRight = 1 << 0,
+	WallWalking = 1 << 1,
+	/** The character sprite was hidden, e.g. after dying. */
+	Hidden = 1 << 2
+};
+ENUM_CLASS_FLAGS(ERlGhostFlags);
+
+/** The character at one sample of a run. */
+struct FRlGhostSample
+{
+	float X;
+	float Y;
+	float Z;
+
+	/** ERlAnimationState of the character. */
+	uint8 State;
+
+	ERlGhostFlags Flags;
+
+	/** Playback position of the flipbook, in frames. */
+	uint16 Frame;
+};
+
+/** One level attempt, from the start of the level until the next one. */
+struct FRlGhostSegment
+{
+	int32 LevelIndex;
+
+	int32 NumSamples;
+
+	/** Offset of the first sample in the file. */
+	int64 SamplesOffset;
+};
+
+/**
+ * Run files (.rlgh) are written in native layout so they can be mapped and read in place:
+ * the header, the samples of every segment one after the other, then the segment table.
+ */
+struct FRlGhostFileHeader
+{
+	static const uint32 Magic = 0x48474c52; // RLGH
+
+	static const uint32 Version = 1;
+
+	uint32 FileMagic;
+
+	uint32 FileVersion;
+
+	/** Samples per second. */
+	float SampleRate;
+
+	int32 NumSegments;
+
+	/** Offset of the segment table, written when the file is closed. */
+	int64 SegmentsOffset;
+};
+
+static_assert(sizeof(FRlGhostSample) == 16, "Ghost samples are mapped from run files");
+static_assert(sizeof(FRlGhostSegment) == 16, "Ghost segments are mapped from run files");
+static_assert(sizeof(FRlGhostFileHeader) == 24, "Ghost headers are mapped from run files");
+
+/** Samples the position and animation of the character at a fixed rate and streams them to a run file. */
+class RAGELITE_API FRlGhostRecorder
+{
+public:
+	FRlGhostRecorder(const FString& InFilename, float InSampleRate = 30.f);
+
+	/** Writes the segment table and the final header. */
+	~FRlGhostRecorder();
+
+	bool IsValid() const { return Writer != nullptr; }
+
+	const FString& GetFilename() const { return Filename; }
+
+	/** Called when a level (re)starts. */
+	void BeginSegment(int32 LevelIndex);
+
+	/** Called once per character tick, writes the samples due since the previous tick. */
+	void Record(const ARlCharacter* Character, float DeltaTime);
+
+	static FString GetDirectory();
+
+private:
+	FString Filename;
+
+	FArchive* Writer;
+
+	float SampleRate;
+
+	/** Time since the last sample. */
+	float Accumulator;
+
+	TArray<FRlGhostSegment> Segments;
+};
+
+/**
+ * A run file mapped in memory, the samples are read in place.
+ * Falls back to loading the file on platforms that cannot map files.
+ */
+class RAGELITE_API FRlGhostRunFile
+{
+public:
+	FRlGhostRunFile();
+
+	~FRlGhostRunFile();
+
+	FRlGhostRunFile(const FRlGhostRunFile&) = delete;
+	FRlGhostRunFile& operator=(const FRlGhostRunFile&) = delete;
+
+	/** Returns false if the file cannot be read or is not a complete run file. */
+	bool Open(const FString& Filename);
+
+	float GetSampleRate() const { return Header ? Header->SampleRate : 0.f; }
+
+	TArrayView<const FRlGhostSegment> GetSegments() const;
+
+	/** Samples of a segment of this file, valid while the file is open. */
+	const FRlGhostSample* GetSamples(const FRlGhostSegment& Segment) const;
+
+private:
+	IMappedFileHandle* MappedHandle;
+
+	IMappedFileRegion* MappedRegion;
+
+	/** File contents when it could not be mapped. */
+	TArray<uint8> Data;
+
+	const uint8* Base;
+
+	int64 Size;
+
+	const FRlGhostFileHeader* Header;
+
+	void Close();
+};
@@ -15,6 +15,13 @@ AHazard::AHazard()
 }
 
 void AHazard::Move(FVector Location, EHazardLocation HazardLocation)
+{
+	FRotator Rotation;
+	GetPlacement(Location, HazardLocation, Location, Rotation);
+	SetActorLocationAndRotation(Location, Rotation);
+}
+
+void AHazard::GetPlacement(FVector Location, EHazardLocation HazardLocation, FVector& OutLocation, FRotator& OutRotation) const
 {
 	float HazardSize = TileSize / 4;
 	float HalfHazardSize = HazardSize / 2;
@@ -91,5 +98,6 @@ void AHazard::Move(FVector Location, EHazardLocation HazardLocation)
 		break;
 	}
 
-	SetActorLocationAndRotation(Location, Rotation);
+	OutLocation = Location;
+	OutRotation = Rotation;
 }
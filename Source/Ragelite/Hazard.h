@@ -22,6 +22,9 @@ public:
 	UPROPERTY(Category = Sprites, EditAnywhere)
 	int32 TileSize;
 
-	virtual void Move(FVector Location, EHazardLocation HazardLocation);
+	void Move(FVector Location, EHazardLocation HazardLocation);
+
+	/** World location and rotation of the hazard at the given slot of the tile centered at Location. */
+	virtual void GetPlacement(FVector Location, EHazardLocation HazardLocation, FVector& OutLocation, FRotator& OutRotation) const;
 	
 };
@@ -1,183 +1,272 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "HazardPool.h"
+#include "Ragelite.h"
 #include "Hazard.h"
 #include "Spike.h"
 #include "Dart.h"
 #include "Stone.h"
+#include "ProjectileManager.h"
 #include "Engine/World.h"
 #include "RlGameInstance.h"
-#include "RlGameMode.h"
 #include "LevelManager.h"
+#include "LevelBake.h"
 #include "Paper2D/Classes/PaperSpriteComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "Paper2D/Classes/PaperGroupedSpriteComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hazard Pool ResetHazards"), STAT_RlResetHazards, STATGROUP_Ragelite);
 
 AHazardPool::AHazardPool()
 {
 	InitialSpikes = 30;
 	InitialDarts = 10;
 	InitialStones = 10;
+	ProjectilesPerDart = 3;
+
+	ProjectileManager = nullptr;
+
+	CurrentLevelBake = nullptr;
+	CurrentBand = INDEX_NONE;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	SpikeSprites = CreateSpriteBatch(TEXT("Spike Sprites"));
+	DartSprites = CreateSpriteBatch(TEXT("Dart Sprites"));
+	StoneSprites = CreateSpriteBatch(TEXT("Stone Sprites"));
 }
 
-void AHazardPool::AddSpikes(int32 SpikesNum)
+UPaperGroupedSpriteComponent* AHazardPool::CreateSpriteBatch(FName Name)
 {
-	FRotator SpawnRotation(0.f);
-	FActorSpawnParameters SpawnInfo;
+	UPaperGroupedSpriteComponent* Batch = CreateDefaultSubobject<UPaperGroupedSpriteComponent>(Name);
+	Batch->SetupAttachment(RootComponent);
+	Batch->SetMobility(EComponentMobility::Movable);
+	Batch->SetCollisionProfileName(FName("NoCollision"));
+	Batch->SetGenerateOverlapEvents(false);
+	return Batch;
+}
 
+void AHazardPool::AddSpriteInstance(UPaperGroupedSpriteComponent* Batch, AHazard* Hazard)
+{
 	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
 
-	for (int32 i = 0; i < SpikesNum; ++i)
-	{
-		ASpike* Spike = GetWorld()->SpawnActor<ASpike>(FVector(10000.f), SpawnRotation, SpawnInfo);
+	UPaperSpriteComponent* RenderComponent = Hazard->GetRenderComponent();
+	RenderComponent->SetVisibility(false);
 
-		UPaperSpriteComponent* RenderComponent = Spike->GetRenderComponent();
-		RenderComponent->SetSprite(LM->GetSpikeSprite());
-		RenderComponent->SetMaterial(0, LM->Material);
+	Batch->AddInstanceWithMaterial(FTransform(FRotator(0.f), RL_POOL_DORMANT_LOCATION, FVector::ZeroVector), RenderComponent->GetSprite(), LM->Material, true);
+}
 
-		Spikes.Add(Spike);
-	}
+void AHazardPool::ShowSpriteInstance(UPaperGroupedSpriteComponent* Batch, int32 Index, const AHazard* Hazard)
+{
+	Batch->UpdateInstanceTransform(Index, Hazard->GetActorTransform(), true);
 }
 
-void AHazardPool::AddSpikesUntil(int32 SpikesNum)
+void AHazardPool::HideSpriteInstance(UPaperGroupedSpriteComponent* Batch, int32 Index)
 {
-	AddSpikes(FMath::Max(0, SpikesNum - Spikes.Num()));
+	Batch->UpdateInstanceTransform(Index, FTransform(FRotator(0.f), RL_POOL_DORMANT_LOCATION, FVector::ZeroVector), true);
 }
 
-void AHazardPool::AddDarts(int32 DartsNum)
+void AHazardPool::Prewarm(const FRlLevelBake& LevelBake)
 {
-	FRotator SpawnRotation(0.f);
-	FActorSpawnParameters SpawnInfo;
+	Spikes.Prewarm(LevelBake.MaxSpikes);
+	Darts.Prewarm(LevelBake.MaxDarts);
+	Stones.Prewarm(LevelBake.MaxStones);
+	ProjectileManager->Pool.Prewarm(LevelBake.MaxDarts * ProjectilesPerDart);
+}
 
-	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
+void AHazardPool::ResetHazards(const FRlLevelBake& LevelBake, int32 Band)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RlResetHazards);
 
-	for (int32 i = 0; i < DartsNum; ++i)
+	if (&LevelBake != CurrentLevelBake)
 	{
-		ADart* Dart = GetWorld()->SpawnActor<ADart>(FVector(10000.f), SpawnRotation, SpawnInfo);
+		CurrentLevelBake = &LevelBake;
+		CurrentBand = Band;
 
-		UPaperSpriteComponent* RenderComponent = Dart->GetRenderComponent();
-		RenderComponent->SetSprite(LM->DartSprite);
-		RenderComponent->SetMaterial(0, LM->Material);
+		SlotHazards.Reset();
+		SlotHazards.SetNumZeroed(LevelBake.Hazards.Num());
 
-		Darts.Add(Dart);
+		PlaceHazards(LevelBake.GetPlacements(Band));
+		return;
 	}
-}
 
-void AHazardPool::AddDartsUntil(int32 DartssNum)
-{
-	AddDarts(FMath::Max(0, DartssNum - Darts.Num()));
+	// Before the changes, so only darts that stay are restarted here
+	Darts.ForEachActive([](ADart* Dart)
+	{
+		Dart->Restart();
+	});
+
+	if (Band == CurrentBand)
+	{
+		return;
+	}
+
+	LevelBake.ForEachChangedHazard(CurrentBand, Band, [this, &LevelBake, Band](int32 Slot)
+	{
+		if (SlotHazards[Slot])
+		{
+			ReleaseHazard(SlotHazards[Slot]);
+			SlotHazards[Slot] = nullptr;
+		}
+		else
+		{
+			SlotHazards[Slot] = AcquireHazard(LevelBake.Hazards[Slot]);
+		}
+	});
+
+	CurrentBand = Band;
+
+	UpdateHazards();
 }
 
-void AHazardPool::AddStones(int32 StonesNum)
+void AHazardPool::PlaceHazards(TArrayView<const FRlHazardPlacement> Placements)
 {
-	FRotator SpawnRotation(0.f);
-	FActorSpawnParameters SpawnInfo;
-
-	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
+	Spikes.ReleaseAll();
+	Darts.ReleaseAll();
+	Stones.ReleaseAll();
 
-	for (int32 i = 0; i < StonesNum; ++i)
+	for (const FRlHazardPlacement& Placement : Placements)
 	{
-		AStone* Stone = GetWorld()->SpawnActor<AStone>(FVector(10000.f), SpawnRotation, SpawnInfo);
+		SlotHazards[Placement.Slot] = AcquireHazard(Placement);
+	}
 
-		UPaperSpriteComponent* RenderComponent = Stone->GetRenderComponent();
-		RenderComponent->SetSprite(LM->GetStoneSprite());
-		RenderComponent->SetMaterial(0, LM->Material);
+	UpdateHazards();
+}
 
-		Stones.Add(Stone);
+AHazard* AHazardPool::AcquireHazard(const FRlHazardPlacement& Placement)
+{
+	if (Placement.Type == EHazardType::Spikes)
+	{
+		ASpike* Spike = Spikes.Acquire(Placement.Location, Placement.Rotation);
+		ShowSpriteInstance(SpikeSprites, Spikes.GetIndex(Spike), Spike);
+		return Spike;
+	}
+	else if (Placement.Type == EHazardType::Darts)
+	{
+		ADart* Dart = Darts.Acquire(Placement.Location, Placement.Rotation);
+		ShowSpriteInstance(DartSprites, Darts.GetIndex(Dart), Dart);
+		Dart->Enable(Placement.DartsDelay, Placement.DartsCooldown, Placement.DartsSpeed);
+		return Dart;
+	}
+	else
+	{
+		AStone* Stone = Stones.Acquire(Placement.Location, Placement.Rotation);
+		ShowSpriteInstance(StoneSprites, Stones.GetIndex(Stone), Stone);
+		return Stone;
 	}
 }
 
-void AHazardPool::AddStonesUntil(int32 StonesNum)
+void AHazardPool::ReleaseHazard(AHazard* Hazard)
 {
-	AddStones(FMath::Max(0, StonesNum - Stones.Num()));
+	if (ASpike* Spike = Cast<ASpike>(Hazard))
+	{
+		Spikes.Release(Spike);
+	}
+	else if (ADart* Dart = Cast<ADart>(Hazard))
+	{
+		Darts.Release(Dart);
+	}
+	else if (AStone* Stone = Cast<AStone>(Hazard))
+	{
+		Stones.Release(Stone);
+	}
 }
 
-void AHazardPool::ResetHazards(TArray<FHazardsData> HazardsData)
+void AHazardPool::UpdateHazards()
 {
-	ARlGameMode* RlGameMode = Cast<ARlGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
-	float CurrentDifficulty = RlGameMode->Difficulty;
-
 	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
 
-	int32 SpikesInUse = 0;
-	int32 DartsInUse = 0;
-	int32 StonesInUse = 0;
+	// The grid can not unmark a single hazard, so it is marked again from the active ones
+	LM->CollisionGrid.ResetHazards();
+
+	Spikes.ForEachActive([LM](ASpike* Spike)
+	{
+		LM->CollisionGrid.AddHazard(Spike->GetRenderComponent());
+	});
 
-	for (int32 i = 0; i < HazardsData.Num(); ++i)
+	Stones.ForEachActive([LM](AStone* Stone)
 	{
+		LM->CollisionGrid.AddHazard(Stone->GetRenderComponent());
+	});
 
-		// If bSpawnsFrom, the hazard will appear from the DifficultyFactor and beyond.
-		// If !bSpawsFrom, the hazard will appear until the DifficultyFactor.
+	// Instance transforms were only written, one render state update per batch
+	SpikeSprites->MarkRenderStateDirty();
+	DartSprites->MarkRenderStateDirty();
+	StoneSprites->MarkRenderStateDirty();
+}
 
+AProjectile* AHazardPool::FireProjectile(const FVector& Location, const FRotator& Rotation, float Speed)
+{
+	return ProjectileManager->Fire(Location, Rotation, Speed);
+}
 
-		if ((!HazardsData[i].bSpawnsFrom && HazardsData[i].DifficultyFactor > CurrentDifficulty) 
-			|| (HazardsData[i].bSpawnsFrom && HazardsData[i].DifficultyFactor <= CurrentDifficulty))
-		{
-			int32 Count = 0;
-
-			for (int32 Number = HazardsData[i].HazardsLocations; Number; Number >>= 1, ++Count)
-			{
-				if (Number & 1)
-				{
-					if (HazardsData[i].HazardsType == EHazardType::Spikes)
-					{
-						Spikes[SpikesInUse++]->Move(LM->GetRelativeLocation(HazardsData[i].Coords, -5.f), static_cast<EHazardLocation>(Count));
-					}
-					else if (HazardsData[i].HazardsType == EHazardType::Darts)
-					{
-						Darts[DartsInUse]->Move(LM->GetRelativeLocation(HazardsData[i].Coords, -5.f), static_cast<EHazardLocation>(Count));
-						Darts[DartsInUse]->Enable(HazardsData[i].DartsDelay, HazardsData[i].DartsCooldown, HazardsData[i].DartsSpeed);
-						++DartsInUse;
-					}
-					else if (HazardsData[i].HazardsType == EHazardType::Stones)
-					{
-						Stones[StonesInUse++]->Move(LM->GetRelativeLocation(HazardsData[i].Coords, -5.f), static_cast<EHazardLocation>(Count));
-					}
-				}
-			}
-		}
-	}
+void AHazardPool::ReleaseProjectiles()
+{
+	ProjectileManager->ReleaseAll();
+}
+
+void AHazardPool::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
 
-	for (int32 i = SpikesInUse; i < Spikes.Num(); ++i)
+	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
+
+	Spikes.Init(this);
+	Spikes.OnSpawned = [this, LM](ASpike* Spike)
 	{
-		Spikes[i]->SetActorLocation(FVector(10000.f));
-	}
+		Spike->GetRenderComponent()->SetSprite(LM->GetSpikeSprite());
+		AddSpriteInstance(SpikeSprites, Spike);
+	};
+	Spikes.OnReleased = [this](ASpike* Spike)
+	{
+		HideSpriteInstance(SpikeSprites, Spikes.GetIndex(Spike));
+	};
 
-	for (int32 i = DartsInUse; i < Darts.Num(); ++i)
+	Darts.Init(this);
+	Darts.OnSpawned = [this, LM](ADart* Dart)
 	{
-		Darts[i]->SetActorLocation(FVector(10000.f));
-		Darts[i]->Disable();
-	}
+		Dart->GetRenderComponent()->SetSprite(LM->DartSprite);
+		AddSpriteInstance(DartSprites, Dart);
+	};
+	Darts.OnReleased = [this](ADart* Dart)
+	{
+		Dart->Disable();
+		HideSpriteInstance(DartSprites, Darts.GetIndex(Dart));
+	};
 
-	for (int32 i = StonesInUse; i < Stones.Num(); ++i)
+	Stones.Init(this);
+	Stones.OnSpawned = [this, LM](AStone* Stone)
 	{
-		Stones[i]->SetActorLocation(FVector(10000.f));
-	}
-}
+		Stone->GetRenderComponent()->SetSprite(LM->GetStoneSprite());
+		AddSpriteInstance(StoneSprites, Stone);
+	};
+	Stones.OnReleased = [this](AStone* Stone)
+	{
+		HideSpriteInstance(StoneSprites, Stones.GetIndex(Stone));
+	};
 
-void AHazardPool::PostInitializeComponents()
-{
-	Super::PostInitializeComponents();
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.Owner = this;
+	ProjectileManager = GetWorld()->SpawnActor<AProjectileManager>(FVector::ZeroVector, FRotator(0.f), SpawnInfo);
 
-	AddSpikes(InitialSpikes);
-	AddDarts(InitialDarts);
+	Spikes.Prewarm(InitialSpikes);
+	Darts.Prewarm(InitialDarts);
+	ProjectileManager->Pool.Prewarm(InitialDarts * ProjectilesPerDart);
 }
 
 void AHazardPool::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	for (int32 i = 0; i < Spikes.Num(); ++i)
-	{
-		Spikes[i]->Destroy();
-	}
+	Spikes.DestroyAll();
+	Darts.DestroyAll();
+	Stones.DestroyAll();
 
-	for (int32 i = 0; i < Darts.Num(); ++i)
-	{
-		Darts[i]->Destroy();
-	}
+	CurrentLevelBake = nullptr;
+	SlotHazards.Reset();
 
-	for (int32 i = 0; i < Stones.Num(); ++i)
+	if (ProjectileManager && !ProjectileManager->IsPendingKill())
 	{
-		Stones[i]->Destroy();
+		ProjectileManager->Destroy();
 	}
-}
\ No newline at end of file
+	ProjectileManager = nullptr;
+}
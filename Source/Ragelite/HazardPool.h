@@ -5,12 +5,18 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "RLTypes.h"
+#include "ActorPool.h"
 #include "HazardPool.generated.h"
 
 class AHazard;
 class ASpike;
 class ADart;
 class AStone;
+class AProjectile;
+class AProjectileManager;
+class UPaperGroupedSpriteComponent;
+struct FRlLevelBake;
+struct FRlHazardPlacement;
 
 UCLASS()
 class RAGELITE_API AHazardPool : public AActor
@@ -23,38 +29,83 @@ public:
 	UPROPERTY(EditAnywhere, Category = Spikes)
 	int32 InitialSpikes;
 
-	TArray<ASpike*> Spikes;
+	TRlActorPool<ASpike> Spikes;
 
 	UPROPERTY(EditAnywhere, Category = Darts)
 	int32 InitialDarts;
 
-	TArray<ADart*> Darts;
+	TRlActorPool<ADart> Darts;
 
 	UPROPERTY(EditAnywhere, Category = Darts)
 	int32 InitialStones;
 
-	TArray<AStone*> Stones;
+	TRlActorPool<AStone> Stones;
 
+	/** Hazards of each type are drawn as instances of one batch, their own sprite components only collide. */
+	UPROPERTY(Category = Sprites, VisibleAnywhere)
+	UPaperGroupedSpriteComponent* SpikeSprites;
 
-public:
-	void AddSpikes(int32 SpikesNum);
+	UPROPERTY(Category = Sprites, VisibleAnywhere)
+	UPaperGroupedSpriteComponent* DartSprites;
+
+	UPROPERTY(Category = Sprites, VisibleAnywhere)
+	UPaperGroupedSpriteComponent* StoneSprites;
+
+	/** Projectiles kept per dart, enough for all the projectiles of a dart in flight at once. */
+	UPROPERTY(EditAnywhere, Category = Darts)
+	int32 ProjectilesPerDart;
 
-	void AddSpikesUntil(int32 SpikesNum);
+	/** Owns and moves the projectiles of the darts. */
+	AProjectileManager* ProjectileManager;
 
-	void AddDarts(int32 DartsNum);
 
-	void AddDartsUntil(int32 DartsNum);
+public:
+	/** Grows the pools to what the level needs at its hardest difficulty, so playing it spawns nothing. */
+	void Prewarm(const FRlLevelBake& LevelBake);
 
-	void AddStones(int32 StonesNum);
+	/**
+	 * Places the hazards of one difficulty band of a level bake, the others go back to the pools.
+	 * On the same level only the hazards whose band membership changed are moved, the others stay put and darts restart.
+	 */
+	void ResetHazards(const FRlLevelBake& LevelBake, int32 Band);
 
-	void AddStonesUntil(int32 StonesNum);
+	AProjectile* FireProjectile(const FVector& Location, const FRotator& Rotation, float Speed);
 
-	void ResetHazards(TArray<FHazardsData> HazardsData);
+	void ReleaseProjectiles();
 
 	virtual void PostInitializeComponents() override;
 
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+private:
+	/** Bake and band the hazards are placed for, null before the first level. */
+	const FRlLevelBake* CurrentLevelBake;
+
+	int32 CurrentBand;
+
+	/** Actor of every hazard slot of the current level, null when the slot is not in the current band. */
+	TArray<AHazard*> SlotHazards;
+
+	/** Releases every hazard and places a band from scratch. */
+	void PlaceHazards(TArrayView<const FRlHazardPlacement> Placements);
+
+	AHazard* AcquireHazard(const FRlHazardPlacement& Placement);
+
+	void ReleaseHazard(AHazard* Hazard);
+
+	/** Marks the active spikes and stones in the collision grid and updates the sprite batches. */
+	void UpdateHazards();
+
+	UPaperGroupedSpriteComponent* CreateSpriteBatch(FName Name);
+
+	/** Hides the sprite component of a new hazard and adds its instance, hidden until the hazard is acquired. */
+	void AddSpriteInstance(UPaperGroupedSpriteComponent* Batch, AHazard* Hazard);
+
+	/** Instances share the index of their hazard in its pool. */
+	void ShowSpriteInstance(UPaperGroupedSpriteComponent* Batch, int32 Index, const AHazard* Hazard);
+
+	void HideSpriteInstance(UPaperGroupedSpriteComponent* Batch, int32 Index);
+
 
 
 
@@ -5,27 +5,14 @@
 #include "Engine/World.h"
 #include "RlGameMode.h"
 #include "RlGameInstance.h"
+#include "SessionRecorder.h"
+#include "LatencyTracer.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogHeartRateModule, Log, All);
 
 UHearRateModule::UHearRateModule()
 {
-	//ScopePercentage = 0.2f;
-	ScopePercentage = 0.15f;
-	//ScopePercentage = 0.1f;
-
-	//DeadZoneFactor = 0.25;
-	DeadZoneFactor = 0.375;
-	//DeadZoneFactor = 0.5;
-
-	HeartRateMin = -1;
-	HeartRateMax = 0;
-
-	//HeartRateMean = 0.f;
-	HeartRateMedian = -1 / 2;
-
 	bEnabled = false;
-	bCalibration = false;
 }
 
 void UHearRateModule::AddHeartRate(uint8 HeartRate)
@@ -33,52 +20,45 @@ void UHearRateModule::AddHeartRate(uint8 HeartRate)
 
 	if (bEnabled && HeartRate)
 	{
+		FRlLatencyTracer* LatencyTracer = GetLatencyTracer();
+		if (LatencyTracer)
+		{
+			LatencyTracer->OnHeartRate();
+		}
 
 		//UKismetSystemLibrary::PrintString(GameMode->GetWorld(), FString::Printf(TEXT("Heart Rate: %i"), HeartRate), true, true, FLinearColor(0.0, 0.66, 1.0), 20.f);
 
-		UE_LOG(LogHeartRateModule, Log, TEXT("Heart Rate: %i"), HeartRate);
+		// Per sample logs are verbose, the session recorder keeps the samples
+		UE_LOG(LogHeartRateModule, Verbose, TEXT("Heart Rate: %i"), HeartRate);
 
-		if (bCalibration)
+		if (FRlSessionRecorder* SessionRecorder = GetSessionRecorder())
 		{
-			HeartRates.Add(HeartRate);
+			SessionRecorder->Record(ERlSessionEvent::HeartRate, HeartRate);
 		}
-		else
-		{
-			float Change = HeartRate - HeartRateMedian;
-			// The difficulty is calculated comparing the current heart rate with the min and max.
-			// Also the median and scope are adjusted.
-			// The median can vary at most one per input received
-
-			// Si su pulso se estabiliza en un nuevo valor debera considerarse estable luego de 2 minutos (30 mediciones aprox)
-
-			HeartRateMedian += Change / 30;
-
-			// El focus se reajusta de tal manera que a lo ms cambie un 5% por minuto
-			// Para que esto ocurra al menos la mitad de las mediciones debieron estar al menos a un 100% de distancia de la deadzone
-
-			float DeadZone = HeartRateMedian * ScopePercentage * DeadZoneFactor;
 
-			float PercentageOutside = FMath::Clamp((FMath::Abs(Change) - DeadZone) / DeadZone, -1.f, 1.f);
+		float TargetDifficulty = Estimator.AddHeartRate(HeartRate);
 
-			ScopePercentage += 0.05f * PercentageOutside / 15;
-
-			HeartRateMin = (1.f - ScopePercentage) * HeartRateMedian;
-			HeartRateMax = (1.f + ScopePercentage) * HeartRateMedian;
+		if (TargetDifficulty >= 0.f && GameMode)
+		{
+			URlGameInstance* RlGI = Cast<URlGameInstance>(GameMode->GetGameInstance());
 
-			if (GameMode)
+			if (RlGI->bDynamicDifficulty && GameMode->Difficulty != TargetDifficulty)
 			{
-				float TargetDifficulty = FMath::Clamp((HeartRateMax - HeartRate) / (HeartRateMax - HeartRateMin), 0.f, 1.f);
-
-				URlGameInstance* RlGI = Cast<URlGameInstance>(GameMode->GetGameInstance());
+				GameMode->Difficulty = TargetDifficulty;
 
-				if (RlGI->bDynamicDifficulty)
+				if (LatencyTracer)
 				{
-					GameMode->Difficulty = TargetDifficulty;
+					LatencyTracer->OnDifficultyChanged();
 				}
 
-				//UKismetSystemLibrary::PrintString(GameMode->GetWorld(), FString::Printf(TEXT("HR Module: M %f P %f D %f"), HeartRateMedian, ScopePercentage, GameMode->Difficulty), true, true, FLinearColor(0.0, 0.66, 1.0), 20.f);
-				UE_LOG(LogHeartRateModule, Log, TEXT("HR Module: M %f P %f D %f"), HeartRateMedian, ScopePercentage, TargetDifficulty);
+				if (RlGI->SessionRecorder)
+				{
+					RlGI->SessionRecorder->Record(ERlSessionEvent::Difficulty, TargetDifficulty);
+				}
 			}
+
+			//UKismetSystemLibrary::PrintString(GameMode->GetWorld(), FString::Printf(TEXT("HR Module: M %f P %f D %f"), HeartRateMedian, ScopePercentage, GameMode->Difficulty), true, true, FLinearColor(0.0, 0.66, 1.0), 20.f);
+			UE_LOG(LogHeartRateModule, Verbose, TEXT("HR Module: M %f P %f D %f"), Estimator.HeartRateMedian, Estimator.ScopePercentage, TargetDifficulty);
 		}
 	}
 }
@@ -91,50 +71,39 @@ void UHearRateModule::AddHeartRate(FString HearRate)
 void UHearRateModule::StartCalibration()
 {
 	UE_LOG(LogHeartRateModule, Log, TEXT("Calibrarion Started"));
-	bEnabled = bCalibration = true;
+	Estimator.StartCalibration();
+	bEnabled = true;
+
+	if (FRlSessionRecorder* SessionRecorder = GetSessionRecorder())
+	{
+		SessionRecorder->Record(ERlSessionEvent::CalibrationStart);
+	}
 }
 
 void UHearRateModule::EndCalibration()
 {
 	UE_LOG(LogHeartRateModule, Log, TEXT("Calibrarion Ended"));
-	bCalibration = false;
 
-	if (HeartRates.Num())
+	if (FRlSessionRecorder* SessionRecorder = GetSessionRecorder())
 	{
-		HeartRates.Sort();
-
-		HeartRateMedian = HeartRates[(HeartRates.Num() - 1) / 2];
-
-		float FirstHalfMean = 0.f;
-		float SecondHalfMean = 0.f;
-
-		for (int32 i = 0; i < HeartRates.Num(); ++i)
-		{
-			if (i < HeartRates.Num() / 2)
-			{
-				FirstHalfMean += HeartRates[i];
-			}
-			else
-			{
-				SecondHalfMean += HeartRates[i];
-			}
-		}
-
-		FirstHalfMean /= HeartRates.Num() / 2;
-		SecondHalfMean /= HeartRates.Num() - (HeartRates.Num() / 2);
-
-		float LowerDeadZone = HeartRateMedian - FirstHalfMean;
-		float HigherDeadZone = SecondHalfMean - HeartRateMedian;
-
-		float DeadZone = HeartRateMedian * ScopePercentage * DeadZoneFactor;
-
-		float PercentageFix = (FMath::Max(LowerDeadZone - DeadZone, 0.f) + FMath::Max(HigherDeadZone - DeadZone, 0.f)) / 2.f;
+		SessionRecorder->Record(ERlSessionEvent::CalibrationEnd);
+	}
 
-		ScopePercentage += PercentageFix / HeartRateMedian;
+	if (Estimator.EndCalibration())
+	{
+		const FRlHeartRateHistogram& Histogram = Estimator.CalibrationHistogram;
+		UE_LOG(LogHeartRateModule, Log, TEXT("Result: %f -> %f - %f (Mean %f Variance %f)"), Estimator.ScopePercentage, Estimator.HeartRateMin, Estimator.HeartRateMax, Histogram.GetMean(), Histogram.GetVariance());
+	}
+}
 
-		HeartRateMin = (1.f - ScopePercentage) * HeartRateMedian;
-		HeartRateMax = (1.f + ScopePercentage) * HeartRateMedian;
+FRlSessionRecorder* UHearRateModule::GetSessionRecorder() const
+{
+	URlGameInstance* RlGI = GameMode ? Cast<URlGameInstance>(GameMode->GetGameInstance()) : nullptr;
+	return RlGI ? RlGI->SessionRecorder : nullptr;
+}
 
-		UE_LOG(LogHeartRateModule, Log, TEXT("Result: %f -> %f - %f"), ScopePercentage, HeartRateMin, HeartRateMax);
-	}
+FRlLatencyTracer* UHearRateModule::GetLatencyTracer() const
+{
+	URlGameInstance* RlGI = GameMode ? Cast<URlGameInstance>(GameMode->GetGameInstance()) : nullptr;
+	return RlGI ? RlGI->LatencyTracer : nullptr;
 }
\ No newline at end of file
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "HeartRateEstimator.h"
 #include "HearRateModule.generated.h"
 
 
 class ARlGameMode;
+class FRlSessionRecorder;
+class FRlLatencyTracer;
 /**
  * 
  */
@@ -19,20 +22,7 @@ class RAGELITE_API UHearRateModule : public UObject
 public:
 	UHearRateModule();
 
-	TArray<uint8> HeartRates;
-
-	// Estimation of heart rate peaks
-	float ScopePercentage;
-
-	// Used to adjust Min and Max
-	float DeadZoneFactor;
-
-	float HeartRateMin;
-	float HeartRateMax;
-
-	float HeartRateMedian;
-
-	//uint64 HeartRateSum;
+	FRlHeartRateEstimator Estimator;
 
 	void AddHeartRate(uint8 HearRate);
 	void AddHeartRate(FString HearRate);
@@ -40,8 +30,6 @@ public:
 	void StartCalibration();
 	void EndCalibration();
 
-	bool bCalibration;
-
 
 	// For debug
 	UPROPERTY()
@@ -50,4 +38,8 @@ public:
 
 //private:
 	bool bEnabled;
+
+	FRlSessionRecorder* GetSessionRecorder() const;
+
+	FRlLatencyTracer* GetLatencyTracer() const;
 };
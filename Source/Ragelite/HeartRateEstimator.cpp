@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HeartRateEstimator.h"
+
+FRlHeartRateEstimator::FRlHeartRateEstimator()
+{
+	//ScopePercentage = 0.2f;
+	ScopePercentage = 0.15f;
+	//ScopePercentage = 0.1f;
+
+	//DeadZoneFactor = 0.25;
+	DeadZoneFactor = 0.375;
+	//DeadZoneFactor = 0.5;
+
+	HeartRateMin = -1;
+	HeartRateMax = 0;
+
+	HeartRateMedian = -1 / 2;
+
+	bCalibration = false;
+}
+
+void FRlHeartRateEstimator::StartCalibration()
+{
+	CalibrationHistogram.Reset();
+	bCalibration = true;
+}
+
+bool FRlHeartRateEstimator::EndCalibration()
+{
+	bCalibration = false;
+
+	const uint32 NumHeartRates = CalibrationHistogram.Num();
+
+	if (NumHeartRates)
+	{
+		HeartRateMedian = CalibrationHistogram.GetMedian();
+
+		float FirstHalfMean = CalibrationHistogram.GetLowerMean(NumHeartRates / 2);
+		float SecondHalfMean = CalibrationHistogram.GetUpperMean(NumHeartRates - (NumHeartRates / 2));
+
+		float LowerDeadZone = HeartRateMedian - FirstHalfMean;
+		float HigherDeadZone = SecondHalfMean - HeartRateMedian;
+
+		float DeadZone = HeartRateMedian * ScopePercentage * DeadZoneFactor;
+
+		float PercentageFix = (FMath::Max(LowerDeadZone - DeadZone, 0.f) + FMath::Max(HigherDeadZone - DeadZone, 0.f)) / 2.f;
+
+		ScopePercentage += PercentageFix / HeartRateMedian;
+
+		HeartRateMin = (1.f - ScopePercentage) * HeartRateMedian;
+		HeartRateMax = (1.f + ScopePercentage) * HeartRateMedian;
+
+		LiveWindow.Fill(CalibrationHistogram.GetMedian());
+
+		return true;
+	}
+
+	return false;
+}
+
+float FRlHeartRateEstimator::AddHeartRate(uint8 HeartRate)
+{
+	if (bCalibration)
+	{
+		CalibrationHistogram.Add(HeartRate);
+		return -1.f;
+	}
+
+	float Change = HeartRate - HeartRateMedian;
+	// The difficulty is calculated comparing the current heart rate with the min and max.
+	// Also the median and scope are adjusted.
+	// The median is taken over a window of the last inputs, seeded with the calibration median
+
+	// Si su pulso se estabiliza en un nuevo valor debera considerarse estable luego de 2 minutos (30 mediciones aprox)
+
+	LiveWindow.Add(HeartRate);
+	HeartRateMedian = LiveWindow.GetHistogram().GetMedian();
+
+	// El focus se reajusta de tal manera que a lo ms cambie un 5% por minuto
+	// Para que esto ocurra al menos la mitad de las mediciones debieron estar al menos a un 100% de distancia de la deadzone
+
+	float DeadZone = HeartRateMedian * ScopePercentage * DeadZoneFactor;
+
+	float PercentageOutside = FMath::Clamp((FMath::Abs(Change) - DeadZone) / DeadZone, -1.f, 1.f);
+
+	ScopePercentage += 0.05f * PercentageOutside / 15;
+
+	HeartRateMin = (1.f - ScopePercentage) * HeartRateMedian;
+	HeartRateMax = (1.f + ScopePercentage) * HeartRateMedian;
+
+	return FMath::Clamp((HeartRateMax - HeartRate) / (HeartRateMax - HeartRateMin), 0.f, 1.f);
+}
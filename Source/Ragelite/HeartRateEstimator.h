@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeartRateStats.h"
+
+/**
+ * Turns heart rate samples into a target difficulty.
+ * Plain data without any world or UObject, so the same math runs in game through UHearRateModule and offline in the replay commandlet.
+ */
+struct RAGELITE_API FRlHeartRateEstimator
+{
+	FRlHeartRateEstimator();
+
+	// Estimation of heart rate peaks
+	float ScopePercentage;
+
+	// Used to adjust Min and Max
+	float DeadZoneFactor;
+
+	float HeartRateMin;
+	float HeartRateMax;
+
+	float HeartRateMedian;
+
+	bool bCalibration;
+
+	/** Every sample received during the calibration. */
+	FRlHeartRateHistogram CalibrationHistogram;
+
+	/** Last samples received after the calibration, the live median is taken from here. */
+	FRlHeartRateWindow LiveWindow;
+
+	void StartCalibration();
+
+	/** Returns false if no sample was received during the calibration. */
+	bool EndCalibration();
+
+	/** Returns the target difficulty in [0, 1], or a negative value while calibrating. */
+	float AddHeartRate(uint8 HeartRate);
+};
@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HeartRateReplayCommandlet.h"
+#include "HeartRateEstimator.h"
+#include "HeartRateTrace.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHeartRateReplay, Log, All);
+
+namespace
+{
+	struct FReplayJob
+	{
+		int32 TraceIndex;
+		float ScopePercentage;
+		float DeadZoneFactor;
+
+		// Results
+		float MeanDifficulty;
+		float StdDevDifficulty;
+		float SaturatedFraction;
+		float FinalScopePercentage;
+		TArray<float> Timeline;
+	};
+
+	TArray<float> ParseList(const FString& Params, const TCHAR* Match, float Default)
+	{
+		TArray<float> Values;
+
+		FString List;
+		if (FParse::Value(*Params, Match, List, false))
+		{
+			TArray<FString> Items;
+			List.ParseIntoArray(Items, TEXT(","));
+			for (const FString& Item : Items)
+			{
+				Values.Add(FCString::Atof(*Item));
+			}
+		}
+
+		if (!Values.Num())
+		{
+			Values.Add(Default);
+		}
+		return Values;
+	}
+
+	void Replay(const FRlHeartRateTrace& Trace, int32 CalibrationSamples, float InitialDifficulty, bool bTimeline, FReplayJob& Job)
+	{
+		FRlHeartRateEstimator Estimator;
+		Estimator.ScopePercentage = Job.ScopePercentage;
+		Estimator.DeadZoneFactor = Job.DeadZoneFactor;
+		Estimator.StartCalibration();
+
+		const int32 CalibrationEnd = Trace.GetCalibrationEnd(CalibrationSamples);
+
+		if (bTimeline)
+		{
+			Job.Timeline.Reset(Trace.HeartRates.Num());
+		}
+
+		float Difficulty = InitialDifficulty;
+		double Sum = 0.0;
+		double SumSquares = 0.0;
+		int32 Saturated = 0;
+		int32 Live = 0;
+
+		for (int32 i = 0; i < Trace.HeartRates.Num(); ++i)
+		{
+			if (i == CalibrationEnd)
+			{
+				Estimator.EndCalibration();
+			}
+
+			// Zero means no reading, the game module ignores them too
+			if (Trace.HeartRates[i])
+			{
+				const float TargetDifficulty = Estimator.AddHeartRate(Trace.HeartRates[i]);
+				if (TargetDifficulty >= 0.f)
+				{
+					Difficulty = TargetDifficulty;
+
+					Sum += Difficulty;
+					SumSquares += Difficulty * Difficulty;
+					Saturated += Difficulty == 0.f || Difficulty == 1.f;
+					Live++;
+				}
+			}
+
+			if (bTimeline)
+			{
+				Job.Timeline.Add(Difficulty);
+			}
+		}
+
+		const double Mean = Live ? Sum / Live : InitialDifficulty;
+		Job.MeanDifficulty = (float)Mean;
+		Job.StdDevDifficulty = Live ? FMath::Sqrt((float)FMath::Max(SumSquares / Live - Mean * Mean, 0.0)) : 0.f;
+		Job.SaturatedFraction = Live ? (float)Saturated / Live : 0.f;
+		Job.FinalScopePercentage = Estimator.ScopePercentage;
+	}
+}
+
+UHeartRateReplayCommandlet::UHeartRateReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UHeartRateReplayCommandlet::Main(const FString& Params)
+{
+	FString Input;
+	if (!FParse::Value(*Params, TEXT("Input="), Input))
+	{
+		UE_LOG(LogHeartRateReplay, Error, TEXT("Missing -Input=<file or directory>"));
+		return 1;
+	}
+
+	FString Output = FPaths::ProjectSavedDir() / TEXT("HeartRateReplay");
+	FParse::Value(*Params, TEXT("Output="), Output);
+
+	const TArray<float> ScopePercentages = ParseList(Params, TEXT("ScopePercentage="), FRlHeartRateEstimator().ScopePercentage);
+	const TArray<float> DeadZoneFactors = ParseList(Params, TEXT("DeadZoneFactor="), FRlHeartRateEstimator().DeadZoneFactor);
+
+	int32 CalibrationSamples = 60;
+	FParse::Value(*Params, TEXT("CalibrationSamples="), CalibrationSamples);
+
+	float InitialDifficulty = 0.5f;
+	FParse::Value(*Params, TEXT("InitialDifficulty="), InitialDifficulty);
+
+	const bool bTimeline = FParse::Param(*Params, TEXT("Timeline"));
+
+	TArray<FString> Files;
+	if (IFileManager::Get().DirectoryExists(*Input))
+	{
+		TArray<FString> Found;
+		IFileManager::Get().FindFiles(Found, *(Input / TEXT("*.*")), true, false);
+		for (const FString& File : Found)
+		{
+			Files.Add(Input / File);
+		}
+	}
+	else
+	{
+		Files.Add(Input);
+	}
+
+	TArray<FRlHeartRateTrace> Traces;
+	Traces.SetNum(Files.Num());
+
+	TArray<bool> Loaded;
+	Loaded.SetNumZeroed(Files.Num());
+
+	ParallelFor(Files.Num(), [&](int32 i)
+	{
+		Loaded[i] = Traces[i].Load(Files[i]);
+	});
+
+	for (int32 i = Traces.Num() - 1; i >= 0; --i)
+	{
+		if (!Loaded[i])
+		{
+			Traces.RemoveAt(i);
+		}
+	}
+
+	if (!Traces.Num())
+	{
+		UE_LOG(LogHeartRateReplay, Error, TEXT("No traces found in %s"), *Input);
+		return 1;
+	}
+
+	TArray<FReplayJob> Jobs;
+	Jobs.Reserve(Traces.Num() * ScopePercentages.Num() * DeadZoneFactors.Num());
+	for (int32 i = 0; i < Traces.Num(); ++i)
+	{
+		for (float ScopePercentage : ScopePercentages)
+		{
+			for (float DeadZoneFactor : DeadZoneFactors)
+			{
+				FReplayJob& Job = Jobs.AddDefaulted_GetRef();
+				Job.TraceIndex = i;
+				Job.ScopePercentage = ScopePercentage;
+				Job.DeadZoneFactor = DeadZoneFactor;
+			}
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ParallelFor(Jobs.Num(), [&](int32 i)
+	{
+		Replay(Traces[Jobs[i].TraceIndex], CalibrationSamples, InitialDifficulty, bTimeline, Jobs[i]);
+	});
+
+	const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogHeartRateReplay, Display, TEXT("Replayed %i sessions in %.3f s (%.0f sessions/s)"), Jobs.Num(), ElapsedTime, Jobs.Num() / FMath::Max(ElapsedTime, 1e-6));
+
+	FString Summary = TEXT("Trace,ScopePercentage,DeadZoneFactor,Samples,MeanDifficulty,StdDevDifficulty,SaturatedFraction,FinalScopePercentage\n");
+	for (const FReplayJob& Job : Jobs)
+	{
+		const FRlHeartRateTrace& Trace = Traces[Job.TraceIndex];
+		Summary += FString::Printf(TEXT("%s,%f,%f,%i,%f,%f,%f,%f\n"), *Trace.Name, Job.ScopePercentage, Job.DeadZoneFactor, Trace.HeartRates.Num(),
+			Job.MeanDifficulty, Job.StdDevDifficulty, Job.SaturatedFraction, Job.FinalScopePercentage);
+	}
+	FFileHelper::SaveStringToFile(Summary, *(Output / TEXT("Summary.csv")));
+
+	if (bTimeline)
+	{
+		for (const FReplayJob& Job : Jobs)
+		{
+			const FRlHeartRateTrace& Trace = Traces[Job.TraceIndex];
+
+			FString Timeline = TEXT("Sample,Timestamp,HeartRate,Difficulty\n");
+			for (int32 i = 0; i < Job.Timeline.Num(); ++i)
+			{
+				const uint64 Timestamp = Trace.Timestamps.Num() ? Trace.Timestamps[i] : 0;
+				Timeline += FString::Printf(TEXT("%i,%llu,%i,%f\n"), i, Timestamp, Trace.HeartRates[i], Job.Timeline[i]);
+			}
+
+			const FString Filename = FString::Printf(TEXT("%s_%g_%g.csv"), *Trace.Name, Job.ScopePercentage, Job.DeadZoneFactor);
+			FFileHelper::SaveStringToFile(Timeline, *(Output / Filename));
+		}
+	}
+
+	UE_LOG(LogHeartRateReplay, Display, TEXT("Results written to %s"), *Output);
+
+	return 0;
+}
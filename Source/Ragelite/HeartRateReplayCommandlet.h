@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HeartRateReplayCommandlet.generated.h"
+
+/**
+ * Replays recorded heart rate traces (.csv, .hr or .rls sessions) through FRlHeartRateEstimator without a world and reports the resulting difficulty.
+ *
+ * UE4Editor-Cmd Ragelite -run=HeartRateReplay -Input=<file or directory> [-Output=<directory>]
+ *     [-ScopePercentage=0.1,0.15,0.2] [-DeadZoneFactor=0.25,0.375,0.5] [-CalibrationSamples=60] [-InitialDifficulty=0.5] [-Timeline]
+ *
+ * Every trace is replayed with every combination of parameters, in parallel. Writes Summary.csv to the output directory,
+ * and with -Timeline one difficulty timeline per replay.
+ */
+UCLASS()
+class RAGELITE_API UHeartRateReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHeartRateReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
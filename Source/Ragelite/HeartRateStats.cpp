@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HeartRateStats.h"
+
+FRlHeartRateHistogram::FRlHeartRateHistogram()
+{
+	Reset();
+}
+
+void FRlHeartRateHistogram::Reset()
+{
+	FMemory::Memzero(Bins);
+	Count = 0;
+	Sum = 0;
+	SumSquares = 0;
+}
+
+void FRlHeartRateHistogram::Add(uint8 HeartRate)
+{
+	Bins[HeartRate]++;
+	Count++;
+	Sum += HeartRate;
+	SumSquares += HeartRate * HeartRate;
+}
+
+void FRlHeartRateHistogram::Remove(uint8 HeartRate)
+{
+	check(Bins[HeartRate]);
+
+	Bins[HeartRate]--;
+	Count--;
+	Sum -= HeartRate;
+	SumSquares -= HeartRate * HeartRate;
+}
+
+uint8 FRlHeartRateHistogram::GetRank(uint32 Rank) const
+{
+	uint32 Accumulated = 0;
+	for (int32 i = 0; i < 256; ++i)
+	{
+		Accumulated += Bins[i];
+		if (Accumulated > Rank)
+		{
+			return i;
+		}
+	}
+	return 255;
+}
+
+uint8 FRlHeartRateHistogram::GetMedian() const
+{
+	return Count ? GetRank((Count - 1) / 2) : 0;
+}
+
+uint8 FRlHeartRateHistogram::GetQuantile(float Quantile) const
+{
+	return Count ? GetRank(FMath::Clamp(FMath::RoundToInt(Quantile * (Count - 1)), 0, (int32)Count - 1)) : 0;
+}
+
+float FRlHeartRateHistogram::GetMean() const
+{
+	return Count ? (float)Sum / Count : 0.f;
+}
+
+float FRlHeartRateHistogram::GetVariance() const
+{
+	if (!Count)
+	{
+		return 0.f;
+	}
+
+	const double Mean = (double)Sum / Count;
+	return FMath::Max((float)((double)SumSquares / Count - Mean * Mean), 0.f);
+}
+
+float FRlHeartRateHistogram::GetLowerMean(uint32 NumSamples) const
+{
+	NumSamples = FMath::Min(NumSamples, Count);
+	if (!NumSamples)
+	{
+		return 0.f;
+	}
+
+	uint32 Remaining = NumSamples;
+	uint64 PartialSum = 0;
+	for (int32 i = 0; i < 256 && Remaining; ++i)
+	{
+		const uint32 Taken = FMath::Min(Bins[i], Remaining);
+		PartialSum += (uint64)Taken * i;
+		Remaining -= Taken;
+	}
+	return (float)PartialSum / NumSamples;
+}
+
+float FRlHeartRateHistogram::GetUpperMean(uint32 NumSamples) const
+{
+	NumSamples = FMath::Min(NumSamples, Count);
+	if (!NumSamples)
+	{
+		return 0.f;
+	}
+
+	uint32 Remaining = NumSamples;
+	uint64 PartialSum = 0;
+	for (int32 i = 255; i >= 0 && Remaining; --i)
+	{
+		const uint32 Taken = FMath::Min(Bins[i], Remaining);
+		PartialSum += (uint64)Taken * i;
+		Remaining -= Taken;
+	}
+	return (float)PartialSum / NumSamples;
+}
+
+FRlHeartRateWindow::FRlHeartRateWindow(int32 InSize)
+	: Size(FMath::Clamp(InSize, 1, MaxSize))
+{
+	Reset();
+}
+
+void FRlHeartRateWindow::Reset()
+{
+	Histogram.Reset();
+	Head = 0;
+}
+
+void FRlHeartRateWindow::Add(uint8 HeartRate)
+{
+	if (Histogram.Num() == (uint32)Size)
+	{
+		Histogram.Remove(Samples[Head]);
+	}
+
+	Samples[Head] = HeartRate;
+	Histogram.Add(HeartRate);
+	Head = (Head + 1) % Size;
+}
+
+void FRlHeartRateWindow::Fill(uint8 HeartRate)
+{
+	Reset();
+	for (int32 i = 0; i < Size; ++i)
+	{
+		Add(HeartRate);
+	}
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Distribution of heart rate samples with fixed memory.
+ * Samples are bytes, so one bin per value keeps quantiles and partial means exact, every query is a scan of 256 bins.
+ */
+struct RAGELITE_API FRlHeartRateHistogram
+{
+	FRlHeartRateHistogram();
+
+	void Reset();
+
+	void Add(uint8 HeartRate);
+
+	void Remove(uint8 HeartRate);
+
+	uint32 Num() const { return Count; }
+
+	/** Sample at the zero based rank, as if the samples were sorted. */
+	uint8 GetRank(uint32 Rank) const;
+
+	/** Lower median, the same element a sorted array would have at (Num - 1) / 2. */
+	uint8 GetMedian() const;
+
+	/** Quantile in [0, 1] by nearest rank. */
+	uint8 GetQuantile(float Quantile) const;
+
+	float GetMean() const;
+
+	float GetVariance() const;
+
+	/** Mean of the lowest NumSamples samples. */
+	float GetLowerMean(uint32 NumSamples) const;
+
+	/** Mean of the highest NumSamples samples. */
+	float GetUpperMean(uint32 NumSamples) const;
+
+private:
+	uint32 Bins[256];
+
+	uint32 Count;
+
+	uint64 Sum;
+
+	uint64 SumSquares;
+};
+
+/** Histogram of the last samples, older samples are removed as new ones arrive. */
+struct RAGELITE_API FRlHeartRateWindow
+{
+	static const int32 MaxSize = 64;
+
+	FRlHeartRateWindow(int32 InSize = 30);
+
+	void Reset();
+
+	void Add(uint8 HeartRate);
+
+	/** Fills the whole window with the same value. */
+	void Fill(uint8 HeartRate);
+
+	int32 GetSize() const { return Size; }
+
+	const FRlHeartRateHistogram& GetHistogram() const { return Histogram; }
+
+private:
+	FRlHeartRateHistogram Histogram;
+
+	uint8 Samples[MaxSize];
+
+	int32 Size;
+
+	int32 Head;
+};
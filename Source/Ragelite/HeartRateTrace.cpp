@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HeartRateTrace.h"
+#include "SessionRecorder.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHeartRateTrace, Log, All);
+
+FRlHeartRateTrace::FRlHeartRateTrace()
+	: CalibrationEnd(INDEX_NONE)
+{
+}
+
+bool FRlHeartRateTrace::Load(const FString& Filename)
+{
+	Name = FPaths::GetBaseFilename(Filename);
+	HeartRates.Reset();
+	Timestamps.Reset();
+	CalibrationEnd = INDEX_NONE;
+
+	const FString Extension = FPaths::GetExtension(Filename);
+
+	if (Extension == TEXT("csv"))
+	{
+		return LoadCsv(Filename);
+	}
+	if (Extension == TEXT("hr"))
+	{
+		return LoadRaw(Filename);
+	}
+	if (Extension == TEXT("rls"))
+	{
+		return LoadSession(Filename);
+	}
+
+	UE_LOG(LogHeartRateTrace, Warning, TEXT("Unknown trace format: %s"), *Filename);
+	return false;
+}
+
+bool FRlHeartRateTrace::LoadCsv(const FString& Filename)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+	{
+		UE_LOG(LogHeartRateTrace, Warning, TEXT("Could not read %s"), *Filename);
+		return false;
+	}
+
+	TArray<FString> Fields;
+	for (const FString& Line : Lines)
+	{
+		if (Line.Contains(TEXT("calibration")))
+		{
+			CalibrationEnd = HeartRates.Num();
+			continue;
+		}
+
+		Fields.Reset();
+		Line.ParseIntoArray(Fields, TEXT(","));
+
+		// Skips headers and empty lines
+		if (!Fields.Num() || !Fields.Last().TrimStartAndEnd().IsNumeric())
+		{
+			continue;
+		}
+
+		HeartRates.Add((uint8)FMath::Clamp(FCString::Atoi(*Fields.Last()), 0, 255));
+
+		if (Fields.Num() > 1)
+		{
+			Timestamps.Add(FCString::Strtoui64(*Fields[0], nullptr, 10));
+		}
+	}
+
+	if (Timestamps.Num() != HeartRates.Num())
+	{
+		Timestamps.Reset();
+	}
+
+	return true;
+}
+
+bool FRlHeartRateTrace::LoadRaw(const FString& Filename)
+{
+	if (!FFileHelper::LoadFileToArray(HeartRates, *Filename))
+	{
+		UE_LOG(LogHeartRateTrace, Warning, TEXT("Could not read %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
+
+bool FRlHeartRateTrace::LoadSession(const FString& Filename)
+{
+	TArray<FRlSessionEvent> Events;
+	if (!FRlSessionRecorder::Load(Filename, Events))
+	{
+		UE_LOG(LogHeartRateTrace, Warning, TEXT("Could not read %s"), *Filename);
+		return false;
+	}
+
+	for (const FRlSessionEvent& Event : Events)
+	{
+		if (Event.Type == ERlSessionEvent::HeartRate)
+		{
+			HeartRates.Add((uint8)Event.Value);
+			Timestamps.Add(Event.Time);
+		}
+		else if (Event.Type == ERlSessionEvent::CalibrationEnd)
+		{
+			CalibrationEnd = HeartRates.Num();
+		}
+	}
+
+	return true;
+}
+
+int32 FRlHeartRateTrace::GetCalibrationEnd(int32 DefaultCalibrationSamples) const
+{
+	return CalibrationEnd != INDEX_NONE ? CalibrationEnd : FMath::Min(DefaultCalibrationSamples, HeartRates.Num());
+}
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Recorded heart rate samples of one session, loaded for offline analysis.
+ *
+ * Supported files:
+ * - .csv: one sample per line, either "HeartRate" or "Timestamp,HeartRate". A line with "calibration" marks the end of the calibration.
+ * - .hr: raw bytes, one sample per byte.
+ * - .rls: session recorded by FRlSessionRecorder.
+ */
+struct RAGELITE_API FRlHeartRateTrace
+{
+	FRlHeartRateTrace();
+
+	FString Name;
+
+	TArray<uint8> HeartRates;
+
+	/** Timestamp of each sample in microseconds, empty if the file has none. */
+	TArray<uint64> Timestamps;
+
+	/** Index of the first sample after the calibration, INDEX_NONE if the file does not say. */
+	int32 CalibrationEnd;
+
+	bool Load(const FString& Filename);
+
+	bool LoadCsv(const FString& Filename);
+
+	bool LoadRaw(const FString& Filename);
+
+	bool LoadSession(const FString& Filename);
+
+	/** Calibration end to use for replays, falls back to the given number of samples. */
+	int32 GetCalibrationEnd(int32 DefaultCalibrationSamples) const;
+};
@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InputRecorder.h"
+#include "RlCharacter.h"
+#include "RlGameMode.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogInputRecorder, Log, All);
+
+FArchive& operator<<(FArchive& Ar, FRlInputFrame& Frame)
+{
+	Ar << Frame.MoveRight;
+	Ar << (uint8&)Frame.Held;
+	Ar << (uint8&)Frame.Pressed;
+	Ar << (uint8&)Frame.Released;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FRlDifficultyChange& Change)
+{
+	Ar << Change.Step;
+	Ar << Change.Difficulty;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FRlInputSegment& Segment)
+{
+	Ar << Segment.LevelIndex;
+	Ar << Segment.Difficulty;
+	Ar << Segment.DifficultyChanges;
+
+	int32 NumFrames = Segment.Frames.Num();
+	Ar << NumFrames;
+
+	if (Ar.IsLoading())
+	{
+		Segment.Frames.Reset(NumFrames);
+		while (Segment.Frames.Num() < NumFrames && !Ar.IsError())
+		{
+			uint32 RunLength = 0;
+			FRlInputFrame Frame;
+			Ar.SerializeIntPacked(RunLength);
+			Ar << Frame;
+
+			RunLength = FMath::Min<uint32>(RunLength, NumFrames - Segment.Frames.Num());
+			for (uint32 i = 0; i < RunLength; ++i)
+			{
+				Segment.Frames.Add(Frame);
+			}
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < NumFrames;)
+		{
+			int32 End = i + 1;
+			while (End < NumFrames && Segment.Frames[End] == Segment.Frames[i])
+			{
+				End++;
+			}
+
+			uint32 RunLength = End - i;
+			Ar.SerializeIntPacked(RunLength);
+			Ar << Segment.Frames[i];
+			i = End;
+		}
+	}
+
+	return Ar;
+}
+
+bool FRlInputRecording::Save(const FString& Filename)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 FileMagic = Magic;
+	uint32 FileVersion = Version;
+	Writer << FileMagic;
+	Writer << FileVersion;
+	Writer << FixedTickRate;
+	Writer << Seed;
+	Writer << Segments;
+
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+bool FRlInputRecording::Load(const FString& Filename)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	Reader << FileMagic;
+	Reader << FileVersion;
+	if (FileMagic != Magic || FileVersion != Version)
+	{
+		return false;
+	}
+
+	Reader << FixedTickRate;
+	Reader << Seed;
+	Reader << Segments;
+
+	return !Reader.IsError();
+}
+
+FRlInputRecorder::FRlInputRecorder(ERlInputRecorderMode InMode, const FString& InFilename, int32 FixedTickRate)
+	: Mode(InMode)
+	, Filename(InFilename)
+	, bValid(true)
+	, SegmentIndex(INDEX_NONE)
+	, Step(0)
+	, Held(ERlInputButton::None)
+	, Pressed(ERlInputButton::None)
+	, Released(ERlInputButton::None)
+	, LastDifficulty(-1.f)
+	, bInjecting(false)
+{
+	if (Mode == ERlInputRecorderMode::Replay)
+	{
+		bValid = Recording.Load(Filename);
+		if (bValid)
+		{
+			UE_LOG(LogInputRecorder, Log, TEXT("Replaying %s: %i level attempts at %i Hz"), *Filename, Recording.Segments.Num(), Recording.FixedTickRate);
+		}
+		else
+		{
+			UE_LOG(LogInputRecorder, Error, TEXT("Could not load input recording %s"), *Filename);
+		}
+	}
+	else
+	{
+		Recording.FixedTickRate = FixedTickRate;
+		Recording.Seed = FPlatformTime::Cycles();
+	}
+}
+
+FRlInputRecorder::~FRlInputRecorder()
+{
+	if (Mode == ERlInputRecorderMode::Record && Recording.Segments.Num())
+	{
+		if (Recording.Save(Filename))
+		{
+			UE_LOG(LogInputRecorder, Log, TEXT("Input recording saved to %s"), *Filename);
+		}
+		else
+		{
+			UE_LOG(LogInputRecorder, Warning, TEXT("Could not save input recording %s"), *Filename);
+		}
+	}
+}
+
+void FRlInputRecorder::BeginSegment(int32 LevelIndex, float& InOutDifficulty)
+{
+	SegmentIndex++;
+	Step = 0;
+	Pressed = Released = ERlInputButton::None;
+
+	if (Mode == ERlInputRecorderMode::Record)
+	{
+		FRlInputSegment& Segment = Recording.Segments.AddDefaulted_GetRef();
+		Segment.LevelIndex = LevelIndex;
+		Segment.Difficulty = InOutDifficulty;
+		LastDifficulty = InOutDifficulty;
+		return;
+	}
+
+	if (!Recording.Segments.IsValidIndex(SegmentIndex))
+	{
+		UE_LOG(LogInputRecorder, Log, TEXT("Replay finished"));
+		return;
+	}
+
+	const FRlInputSegment& Segment = Recording.Segments[SegmentIndex];
+	if (Segment.LevelIndex != LevelIndex)
+	{
+		UE_LOG(LogInputRecorder, Warning, TEXT("Replay diverged: level %i was recorded, level %i started"), Segment.LevelIndex, LevelIndex);
+	}
+
+	InOutDifficulty = Segment.Difficulty;
+}
+
+bool FRlInputRecorder::OnButton(ERlInputButton Button, bool bPressed)
+{
+	if (Mode == ERlInputRecorderMode::Replay)
+	{
+		return bInjecting;
+	}
+
+	if (bPressed)
+	{
+		Held |= Button;
+		Pressed |= Button;
+	}
+	else
+	{
+		Held &= ~Button;
+		Released |= Button;
+	}
+	return true;
+}
+
+void FRlInputRecorder::ProcessStep(ARlCharacter* Character, FVector& InOutInputVector)
+{
+	ARlGameMode* GameMode = Cast<ARlGameMode>(Character->GetWorld()->GetAuthGameMode());
+
+	if (Mode == ERlInputRecorderMode::Record)
+	{
+		if (!Recording.Segments.IsValidIndex(SegmentIndex))
+		{
+			return;
+		}
+
+		FRlInputSegment& Segment = Recording.Segments[SegmentIndex];
+
+		FRlInputFrame& Frame = Segment.Frames.AddDefaulted_GetRef();
+		Frame.MoveRight = (int8)FMath::Clamp(FMath::RoundToInt(InOutInputVector.X * 127.f), -127, 127);
+		Frame.Held = Held;
+		Frame.Pressed = Pressed;
+		Frame.Released = Released;
+		Pressed = Released = ERlInputButton::None;
+
+		// The live run uses the quantized input too, otherwise the replay would drift
+		InOutInputVector.X = Frame.MoveRight / 127.f;
+
+		if (GameMode && GameMode->Difficulty != LastDifficulty)
+		{
+			Segment.DifficultyChanges.Add({ Step, GameMode->Difficulty });
+			LastDifficulty = GameMode->Difficulty;
+		}
+
+		Step++;
+		return;
+	}
+
+	InOutInputVector = FVector::ZeroVector;
+
+	if (!Recording.Segments.IsValidIndex(SegmentIndex))
+	{
+		return;
+	}
+
+	const FRlInputSegment& Segment = Recording.Segments[SegmentIndex];
+
+	for (const FRlDifficultyChange& Change : Segment.DifficultyChanges)
+	{
+		if (Change.Step == Step && GameMode)
+		{
+			GameMode->Difficulty = Change.Difficulty;
+		}
+	}
+
+	if (Segment.Frames.IsValidIndex(Step))
+	{
+		const FRlInputFrame& Frame = Segment.Frames[Step];
+
+		bInjecting = true;
+		ApplyButtons(Character, Frame, ERlInputButton::Jump);
+		ApplyButtons(Character, Frame, ERlInputButton::Sprint);
+		ApplyButtons(Character, Frame, ERlInputButton::Up);
+		bInjecting = false;
+
+		InOutInputVector.X = Frame.MoveRight / 127.f;
+	}
+
+	Step++;
+}
+
+void FRlInputRecorder::ApplyButtons(ARlCharacter* Character, const FRlInputFrame& Frame, ERlInputButton Button)
+{
+	const bool bPressed = EnumHasAnyFlags(Frame.Pressed, Button);
+	const bool bReleased = EnumHasAnyFlags(Frame.Released, Button);
+	const bool bHeld = EnumHasAnyFlags(Frame.Held, Button);
+
+	auto Press = [Character, Button]()
+	{
+		switch (Button)
+		{
+		case ERlInputButton::Jump:
+			Character->Jump(FKey());
+			break;
+		case ERlInputButton::Sprint:
+			Character->Sprint();
+			break;
+		case ERlInputButton::Up:
+			Character->Up();
+			break;
+		default:
+			break;
+		}
+	};
+
+	auto Release = [Character, Button]()
+	{
+		switch (Button)
+		{
+		case ERlInputButton::Jump:
+			Character->StopJumping();
+			break;
+		case ERlInputButton::Sprint:
+			Character->StopSprinting();
+			break;
+		default:
+			break;
+		}
+	};
+
+	// When both happened in the same step the held state tells which one came last
+	if (bPressed && bReleased && bHeld)
+	{
+		Release();
+		Press();
+	}
+	else
+	{
+		if (bPressed)
+		{
+			Press();
+		}
+		if (bReleased)
+		{
+			Release();
+		}
+	}
+}
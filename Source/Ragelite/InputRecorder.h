@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ARlCharacter;
+
+enum class ERlInputButton : uint8
+{
+	None = 0,
+	Jump = 1 << 0,
+	Sprint = 1 << 1,
+	Up = 1 << 2
+};
+ENUM_CLASS_FLAGS(ERlInputButton);
+
+/** Input of the character during one fixed movement step. */
+struct FRlInputFrame
+{
+	/** Movement input along X, quantized to [-127, 127]. */
+	int8 MoveRight;
+
+	/** Buttons held at the end of the step. */
+	ERlInputButton Held;
+
+	/** Buttons pressed or released since the previous step, a quick tap can be both. */
+	ERlInputButton Pressed;
+	ERlInputButton Released;
+
+	FRlInputFrame() : MoveRight(0), Held(ERlInputButton::None), Pressed(ERlInputButton::None), Released(ERlInputButton::None) {};
+
+	bool operator==(const FRlInputFrame& Other) const
+	{
+		return MoveRight == Other.MoveRight && Held == Other.Held && Pressed == Other.Pressed && Released == Other.Released;
+	}
+};
+
+struct FRlDifficultyChange
+{
+	uint32 Step;
+
+	float Difficulty;
+};
+
+/** Inputs from the start of a level attempt until the next one. */
+struct FRlInputSegment
+{
+	int32 LevelIndex;
+
+	/** Difficulty when the level started, it decides which hazards are placed. */
+	float Difficulty;
+
+	TArray<FRlDifficultyChange> DifficultyChanges;
+
+	TArray<FRlInputFrame> Frames;
+
+	FRlInputSegment() : LevelIndex(0), Difficulty(0.5f) {};
+
+	/** Frames are run length encoded, most steps repeat the previous input. */
+	friend FArchive& operator<<(FArchive& Ar, FRlInputSegment& Segment);
+};
+
+/** A whole run: the simulation settings and one segment per level attempt. */
+struct FRlInputRecording
+{
+	static const uint32 Magic = 0x4e494c52; // RLIN
+
+	static const uint32 Version = 1;
+
+	int32 FixedTickRate;
+
+	int32 Seed;
+
+	TArray<FRlInputSegment> Segments;
+
+	FRlInputRecording() : FixedTickRate(120), Seed(0) {};
+
+	bool Save(const FString& Filename);
+
+	bool Load(const FString& Filename);
+};
+
+enum class ERlInputRecorderMode : uint8
+{
+	Record,
+	Replay
+};
+
+/**
+ * Records the character input of every fixed movement step, or feeds a recorded run back to the character.
+ * Movement only depends on these inputs and on the difficulty, so a replay re-simulates the run exactly.
+ */
+class RAGELITE_API FRlInputRecorder
+{
+public:
+	/** FixedTickRate is only used when recording, replays use the recorded one. */
+	FRlInputRecorder(ERlInputRecorderMode InMode, const FString& InFilename, int32 FixedTickRate = 120);
+
+	/** Saves the recording when recording. */
+	~FRlInputRecorder();
+
+	bool IsValid() const { return bValid; }
+
+	bool IsReplaying() const { return Mode == ERlInputRecorderMode::Replay; }
+
+	const FRlInputRecording& GetRecording() const { return Recording; }
+
+	/** Called when a level (re)starts, before the hazards are placed. Replays set the recorded difficulty. */
+	void BeginSegment(int32 LevelIndex, float& InOutDifficulty);
+
+	/** Called by the input handlers. Returns false if the input must be ignored, which is the case for player input during a replay. */
+	bool OnButton(ERlInputButton Button, bool bPressed);
+
+	/** Called before every fixed movement step. Records the step input, or replaces it with the recorded one. */
+	void ProcessStep(ARlCharacter* Character, FVector& InOutInputVector);
+
+private:
+	ERlInputRecorderMode Mode;
+
+	FString Filename;
+
+	bool bValid;
+
+	FRlInputRecording Recording;
+
+	int32 SegmentIndex;
+
+	/** Step inside the current segment. */
+	uint32 Step;
+
+	ERlInputButton Held;
+	ERlInputButton Pressed;
+	ERlInputButton Released;
+
+	float LastDifficulty;
+
+	/** True while the replay calls the input handlers. */
+	bool bInjecting;
+
+	void ApplyButtons(ARlCharacter* Character, const FRlInputFrame& Frame, ERlInputButton Button);
+};
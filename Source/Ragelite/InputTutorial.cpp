@@ -45,15 +45,15 @@ UWorld* UInputTutorial::GetWorld() const
 	return RlGameInstance->GetWorld();
 }
 
-void UInputTutorial::Update(int32 CurrentLevelIndex, bool bIsUsingGamepad)
+void UInputTutorial::Update(int32 CurrentLevelIndex, const FRlLevelProgression& Progression, bool bIsUsingGamepad)
 {
 	bool bLastWasUsingGamepad = bWasUsingGamepad;
 	bWasUsingGamepad = bIsUsingGamepad;
 	if (bInit)
 	{
-		if (TileMaps.IsValidIndex(CurrentLevelIndex - 1))
+		if (TileMaps.IsValidIndex(Progression.TutorialTileMap))
 		{
-			UPaperTileMap* CurrentTileMap = TileMaps[CurrentLevelIndex - 1];
+			UPaperTileMap* CurrentTileMap = TileMaps[Progression.TutorialTileMap];
 			if (CurrentTileMap != LastTileMap || LastLevel != CurrentLevelIndex)
 			{
 				LastTileMap = CurrentTileMap;
@@ -63,62 +63,18 @@ void UInputTutorial::Update(int32 CurrentLevelIndex, bool bIsUsingGamepad)
 				GetWorld()->GetTimerManager().ClearTimer(SecondaryAnimationHandle);
 
 				UPaperTileMapComponent* RenderComponent = TileMapActor->GetRenderComponent();
-				RenderComponent->SetTileMap(TileMaps[CurrentLevelIndex - 1]);
+				RenderComponent->SetTileMap(CurrentTileMap);
 				RenderComponent->SetVisibility(true);
 
 				for (int32 i = 0; i < RenderComponent->TileMap->TileLayers.Num(); ++i)
 				{
 					HideLayer(i);
 				}
-				switch (CurrentLevelIndex)
-				{
-				case 1:
-					LevelOneOne();
-					break;
-				case 2:
-				case 5:
-					LevelTwoOne();
-					break;
-				case 3:
-					LevelThreeOne();
-					break;
-				case 4:
-					LevelFourOne();
-					break;
-				default:
-					break;
-				}
+				StartAnimation(Progression.TutorialAnimation);
 			}
 			else if (bLastWasUsingGamepad != bWasUsingGamepad)
 			{
-				switch (CurrentLevelIndex)
-				{
-				case 1:
-					ToggleLayers(0, 3);
-					ToggleLayers(1, 4);
-					ToggleLayers(2, 5);
-
-					ToggleLayers(6, 8);
-					ToggleLayers(7, 9);
-					break;
-				case 2:
-				case 5:
-					ToggleLayers(0, 3);
-					ToggleLayers(1, 4);
-					ToggleLayers(2, 5);
-					break;
-				case 3:
-				case 4:
-					ToggleLayers(0, 2);
-					ToggleLayers(1, 3);
-					//ToggleLayers(0, 4);
-					//ToggleLayers(1, 5);
-					//ToggleLayers(2, 6);
-					//ToggleLayers(3, 7);
-					break;
-				default:
-					break;
-				}
+				ToggleAnimationLayers(Progression.TutorialAnimation);
 			}
 		}
 		else
@@ -128,6 +84,53 @@ void UInputTutorial::Update(int32 CurrentLevelIndex, bool bIsUsingGamepad)
 	}
 }
 
+void UInputTutorial::StartAnimation(ERlInputTutorial Animation)
+{
+	// Indexed by ERlInputTutorial
+	static void (UInputTutorial::*const FirstFrames[])() =
+	{
+		nullptr,
+		&UInputTutorial::LevelOneOne,
+		&UInputTutorial::LevelTwoOne,
+		&UInputTutorial::LevelThreeOne,
+		&UInputTutorial::LevelFourOne
+	};
+
+	const int32 Index = (int32)Animation;
+	if (Index < ARRAY_COUNT(FirstFrames) && FirstFrames[Index])
+	{
+		(this->*FirstFrames[Index])();
+	}
+}
+
+void UInputTutorial::ToggleAnimationLayers(ERlInputTutorial Animation)
+{
+	struct FLayerPairs
+	{
+		int32 Num;
+		int32 Layers[5][2];
+	};
+
+	// Keyboard and gamepad layers, indexed by ERlInputTutorial
+	static const FLayerPairs AnimationLayers[] =
+	{
+		{ 0 },
+		{ 5, { { 0, 3 }, { 1, 4 }, { 2, 5 }, { 6, 8 }, { 7, 9 } } },
+		{ 3, { { 0, 3 }, { 1, 4 }, { 2, 5 } } },
+		{ 2, { { 0, 2 }, { 1, 3 } } },
+		{ 2, { { 0, 2 }, { 1, 3 } } }
+	};
+
+	const int32 Index = (int32)Animation;
+	if (Index < ARRAY_COUNT(AnimationLayers))
+	{
+		for (int32 i = 0; i < AnimationLayers[Index].Num; ++i)
+		{
+			ToggleLayers(AnimationLayers[Index].Layers[i][0], AnimationLayers[Index].Layers[i][1]);
+		}
+	}
+}
+
 void UInputTutorial::HideLayer(int32 Layer)
 {
 	SetLayerVisibility(Layer, false);
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "TimerManager.h"
+#include "RLTypes.h"
 #include "InputTutorial.generated.h"
 
 class APaperTileMapActor;
@@ -31,7 +32,8 @@ public:
 
 	virtual UWorld* GetWorld() const override;
 
-	void Update(int32 CurrentLevelIndex, bool bIsUsingGamepad);
+	/** Shows the tutorial of the level progression, switching keyboard and gamepad layers when the input changes. */
+	void Update(int32 CurrentLevelIndex, const FRlLevelProgression& Progression, bool bIsUsingGamepad);
 
 private:
 	bool bInit;
@@ -49,6 +51,11 @@ private:
 	void ShowLayers(int32 KeyboardLayer, int32 GamepadLayer);
 	void ShowOnlyLayers(int32 KeyboardLayer, int32 GamepadLayer);
 
+	void StartAnimation(ERlInputTutorial Animation);
+
+	/** Swaps the keyboard and gamepad layers of an animation. */
+	void ToggleAnimationLayers(ERlInputTutorial Animation);
+
 	UPaperTileMap* LastTileMap;
 	int32 LastLevel;
 	bool bWasUsingGamepad;
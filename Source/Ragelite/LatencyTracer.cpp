@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LatencyTracer.h"
+#include "BridgeProtocol.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLatency, Log, All);
+
+FRlLatencyHistogram::FRlLatencyHistogram()
+{
+	Reset();
+}
+
+void FRlLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Bins);
+	Count = 0;
+	Sum = 0;
+	Min = MAX_uint64;
+	Max = 0;
+}
+
+int32 FRlLatencyHistogram::GetBinIndex(uint64 Micros)
+{
+	return Micros ? FMath::Min((int32)FMath::FloorLog2_64(Micros), NumBins - 1) : 0;
+}
+
+void FRlLatencyHistogram::Add(uint64 Micros)
+{
+	Bins[GetBinIndex(Micros)]++;
+	Count++;
+	Sum += Micros;
+	Min = FMath::Min(Min, Micros);
+	Max = FMath::Max(Max, Micros);
+}
+
+uint64 FRlLatencyHistogram::GetQuantile(float Quantile) const
+{
+	if (!Count)
+	{
+		return 0;
+	}
+
+	const uint32 Rank = FMath::Clamp(FMath::RoundToInt(Quantile * (Count - 1)), 0, (int32)Count - 1);
+
+	uint32 Accumulated = 0;
+	for (int32 Bin = 0; Bin < NumBins; ++Bin)
+	{
+		Accumulated += Bins[Bin];
+		if (Accumulated > Rank)
+		{
+			return FMath::Min(GetBinMax(Bin), Max);
+		}
+	}
+	return Max;
+}
+
+FRlLatencyTracer::FRlLatencyTracer()
+	: ReceivedCycles(0)
+	, HeartRateReceivedCycles(0)
+	, HeartRateCycles(0)
+	, PendingReceivedCycles(0)
+	, PendingHeartRateCycles(0)
+{
+}
+
+uint64 FRlLatencyTracer::CyclesToMicros(uint64 Cycles)
+{
+	return (uint64)(FPlatformTime::GetSecondsPerCycle64() * Cycles * 1000000.0);
+}
+
+void FRlLatencyTracer::OnReceived(const FRlBridgeMessage& Message)
+{
+	if (!Message.ReceiveCycles)
+	{
+		return;
+	}
+
+	ReceivedCycles = Message.ReceiveCycles;
+
+	if (Message.Timestamp)
+	{
+		BridgeOffsets.Add((int64)CyclesToMicros(Message.ReceiveCycles) - (int64)Message.Timestamp);
+	}
+}
+
+void FRlLatencyTracer::OnHeartRate()
+{
+	if (!ReceivedCycles)
+	{
+		return;
+	}
+
+	HeartRateReceivedCycles = ReceivedCycles;
+	HeartRateCycles = FPlatformTime::Cycles64();
+	ReceivedCycles = 0;
+
+	Histograms[(int32)ERlLatencyHop::ReceiptToHeartRate].Add(CyclesToMicros(HeartRateCycles - HeartRateReceivedCycles));
+}
+
+void FRlLatencyTracer::OnDifficultyChanged()
+{
+	if (!HeartRateCycles)
+	{
+		return;
+	}
+
+	// The respawn applies the latest difficulty, so the latest change is the one measured
+	PendingReceivedCycles = HeartRateReceivedCycles;
+	PendingHeartRateCycles = HeartRateCycles;
+}
+
+void FRlLatencyTracer::OnDifficultyApplied()
+{
+	if (!PendingHeartRateCycles)
+	{
+		return;
+	}
+
+	const uint64 Cycles = FPlatformTime::Cycles64();
+	Histograms[(int32)ERlLatencyHop::HeartRateToRespawn].Add(CyclesToMicros(Cycles - PendingHeartRateCycles));
+	Histograms[(int32)ERlLatencyHop::ReceiptToRespawn].Add(CyclesToMicros(Cycles - PendingReceivedCycles));
+
+	PendingReceivedCycles = 0;
+	PendingHeartRateCycles = 0;
+}
+
+FRlLatencyHistogram FRlLatencyTracer::GetHistogram(ERlLatencyHop Hop) const
+{
+	if (Hop != ERlLatencyHop::BridgeToReceipt)
+	{
+		return Histograms[(int32)Hop];
+	}
+
+	FRlLatencyHistogram Histogram;
+	if (BridgeOffsets.Num())
+	{
+		const int64 MinOffset = FMath::Min(BridgeOffsets);
+		for (int64 Offset : BridgeOffsets)
+		{
+			Histogram.Add(Offset - MinOffset);
+		}
+	}
+	return Histogram;
+}
+
+const TCHAR* FRlLatencyTracer::GetHopName(ERlLatencyHop Hop)
+{
+	switch (Hop)
+	{
+	case ERlLatencyHop::BridgeToReceipt:
+		return TEXT("BridgeToReceipt");
+	case ERlLatencyHop::ReceiptToHeartRate:
+		return TEXT("ReceiptToHeartRate");
+	case ERlLatencyHop::HeartRateToRespawn:
+		return TEXT("HeartRateToRespawn");
+	case ERlLatencyHop::ReceiptToRespawn:
+		return TEXT("ReceiptToRespawn");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+FString FRlLatencyTracer::GetDefaultFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Latency") / FDateTime::Now().ToString() + TEXT(".csv");
+}
+
+bool FRlLatencyTracer::Export(const FString& Filename) const
+{
+	FString Csv = TEXT("Hop,Count,MinMs,MeanMs,P50Ms,P90Ms,P99Ms,MaxMs\n");
+
+	FRlLatencyHistogram HopHistograms[(int32)ERlLatencyHop::Num];
+	for (int32 Hop = 0; Hop < (int32)ERlLatencyHop::Num; ++Hop)
+	{
+		HopHistograms[Hop] = GetHistogram((ERlLatencyHop)Hop);
+
+		const FRlLatencyHistogram& Histogram = HopHistograms[Hop];
+		Csv += FString::Printf(TEXT("%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"), GetHopName((ERlLatencyHop)Hop), Histogram.Num(),
+			Histogram.GetMin() / 1000.0, Histogram.GetMean() / 1000.0, Histogram.GetQuantile(0.5f) / 1000.0,
+			Histogram.GetQuantile(0.9f) / 1000.0, Histogram.GetQuantile(0.99f) / 1000.0, Histogram.GetMax() / 1000.0);
+	}
+
+	// Empty bins are left out
+	Csv += TEXT("\nHop,FromMs,ToMs,Count\n");
+	for (int32 Hop = 0; Hop < (int32)ERlLatencyHop::Num; ++Hop)
+	{
+		for (int32 Bin = 0; Bin < FRlLatencyHistogram::NumBins; ++Bin)
+		{
+			if (const uint32 Count = HopHistograms[Hop].GetBin(Bin))
+			{
+				Csv += FString::Printf(TEXT("%s,%.3f,%.3f,%u\n"), GetHopName((ERlLatencyHop)Hop), FRlLatencyHistogram::GetBinMin(Bin) / 1000.0, FRlLatencyHistogram::GetBinMax(Bin) / 1000.0, Count);
+			}
+		}
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Filename);
+}
+
+void FRlLatencyTracer::LogSummary() const
+{
+	for (int32 Hop = 0; Hop < (int32)ERlLatencyHop::Num; ++Hop)
+	{
+		const FRlLatencyHistogram Histogram = GetHistogram((ERlLatencyHop)Hop);
+		UE_LOG(LogLatency, Log, TEXT("%s: %u samples, p50 %.1f ms, p99 %.1f ms, max %.1f ms"), GetHopName((ERlLatencyHop)Hop), Histogram.Num(),
+			Histogram.GetQuantile(0.5f) / 1000.0, Histogram.GetQuantile(0.99f) / 1000.0, Histogram.GetMax() / 1000.0);
+	}
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRlBridgeMessage;
+
+/** Distribution of latencies with fixed memory, one bin per power of two microseconds. */
+struct RAGELITE_API FRlLatencyHistogram
+{
+	static const int32 NumBins = 40;
+
+	FRlLatencyHistogram();
+
+	void Reset();
+
+	void Add(uint64 Micros);
+
+	uint32 Num() const { return Count; }
+
+	/** Quantile in [0, 1] by nearest rank, as the upper bound of its bin. */
+	uint64 GetQuantile(float Quantile) const;
+
+	double GetMean() const { return Count ? (double)Sum / Count : 0.0; }
+
+	uint64 GetMin() const { return Count ? Min : 0; }
+
+	uint64 GetMax() const { return Max; }
+
+	uint32 GetBin(int32 Bin) const { return Bins[Bin]; }
+
+	/** Bin 0 holds 0 and 1 us, bin N holds [2^N, 2^(N+1)). */
+	static int32 GetBinIndex(uint64 Micros);
+
+	static uint64 GetBinMin(int32 Bin) { return Bin ? 1ull << Bin : 0; }
+
+	static uint64 GetBinMax(int32 Bin) { return (1ull << (Bin + 1)) - 1; }
+
+private:
+	uint32 Bins[NumBins];
+
+	uint32 Count;
+
+	uint64 Sum;
+
+	uint64 Min;
+
+	uint64 Max;
+};
+
+/** Steps of the heart rate to difficulty loop. */
+enum class ERlLatencyHop : uint8
+{
+	/** Bridge timestamp to receipt by the game. The clocks are not shared, so relative to the fastest sample of the session. */
+	BridgeToReceipt,
+	/** Receipt on the bridge thread to UHearRateModule::AddHeartRate on the game thread. */
+	ReceiptToHeartRate,
+	/** AddHeartRate changing the difficulty to the next respawn placing hazards with it. */
+	HeartRateToRespawn,
+	/** Receipt of the sample that changed the difficulty to the respawn using it. */
+	ReceiptToRespawn,
+	Num
+};
+
+/**
+ * Follows heart rate samples from the bridge until a respawn applies the difficulty they produced,
+ * with a latency histogram per hop. Game thread only, the receipt time is taken by the bridge receiver and carried in the message.
+ */
+class RAGELITE_API FRlLatencyTracer
+{
+public:
+	FRlLatencyTracer();
+
+	/** A heart rate message was taken from the bridge queue. */
+	void OnReceived(const FRlBridgeMessage& Message);
+
+	/** The heart rate module got the last received sample. */
+	void OnHeartRate();
+
+	/** The last sample changed the difficulty. */
+	void OnDifficultyChanged();
+
+	/** A respawn placed the hazards with the current difficulty. */
+	void OnDifficultyApplied();
+
+	FRlLatencyHistogram GetHistogram(ERlLatencyHop Hop) const;
+
+	/** Writes a summary and the bins of every hop as csv. */
+	bool Export(const FString& Filename) const;
+
+	void LogSummary() const;
+
+	static const TCHAR* GetHopName(ERlLatencyHop Hop);
+
+	static FString GetDefaultFilename();
+
+private:
+	FRlLatencyHistogram Histograms[(int32)ERlLatencyHop::Num];
+
+	/** Receipt time minus bridge timestamp of every sample, turned into a histogram once the fastest one is known. */
+	TArray<int64> BridgeOffsets;
+
+	/** Cycles of the last received sample, 0 once the heart rate module took it. */
+	uint64 ReceivedCycles;
+
+	/** Cycles of the last sample taken by the heart rate module. */
+	uint64 HeartRateReceivedCycles;
+	uint64 HeartRateCycles;
+
+	/** Sample that produced the difficulty not applied yet, 0 if none. */
+	uint64 PendingReceivedCycles;
+	uint64 PendingHeartRateCycles;
+
+	static uint64 CyclesToMicros(uint64 Cycles);
+};
@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LevelBake.h"
+#include "LevelManager.h"
+#include "Spike.h"
+#include "Dart.h"
+#include "Stone.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Paper2D/Classes/PaperTileMap.h"
+#include "Algo/BinarySearch.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	template<typename T>
+	void HashValue(uint32& Crc, const T& Value)
+	{
+		Crc = FCrc::MemCrc32(&Value, sizeof(T), Crc);
+	}
+
+	const AHazard* GetHazardDefault(EHazardType Type)
+	{
+		switch (Type)
+		{
+		case EHazardType::Darts:
+			return GetDefault<ADart>();
+		case EHazardType::Stones:
+			return GetDefault<AStone>();
+		default:
+			return GetDefault<ASpike>();
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FRlHazardPlacement& Placement)
+{
+	Ar << (uint8&)Placement.Type;
+	Ar << Placement.FirstBand;
+	Ar << Placement.LastBand;
+	Ar << Placement.Slot;
+	Ar << Placement.Location;
+	Ar << Placement.Rotation;
+	Ar << Placement.DartsDelay;
+	Ar << Placement.DartsCooldown;
+	Ar << Placement.DartsSpeed;
+	return Ar;
+}
+
+FRlLevelBake::FRlLevelBake()
+	: SourceHash(0)
+	, Start(FVector::ZeroVector)
+	, Stairs(FVector::ZeroVector)
+	, MaxSpikes(0)
+	, MaxDarts(0)
+	, MaxStones(0)
+	, CollisionMinY(0.f)
+	, CollisionMaxY(0.f)
+	, bBoxCollision(false)
+{
+}
+
+int32 FRlLevelBake::GetBand(float Difficulty) const
+{
+	return FMath::Min(Algo::UpperBound(BandThresholds, Difficulty), BandOffsets.Num() - 2);
+}
+
+TArrayView<const FRlHazardPlacement> FRlLevelBake::GetPlacements(int32 Band) const
+{
+	if (Band < 0 || Band + 1 >= BandOffsets.Num())
+	{
+		return TArrayView<const FRlHazardPlacement>();
+	}
+
+	return TArrayView<const FRlHazardPlacement>(Placements.GetData() + BandOffsets[Band], BandOffsets[Band + 1] - BandOffsets[Band]);
+}
+
+bool FRlLevelBake::Bake(const ULevelManager* LevelManager, int32 LevelIndex)
+{
+	*this = FRlLevelBake();
+
+	if (!LevelManager->Levels.IsValidIndex(LevelIndex))
+	{
+		return false;
+	}
+
+	const FRlLevel& Level = LevelManager->Levels[LevelIndex];
+
+	SourceHash = ComputeSourceHash(LevelManager, LevelIndex);
+	Start = LevelManager->GetRelativeLocation(Level.Start) - FVector(0.f, 0.f, 4.f);
+	Stairs = LevelManager->GetRelativeLocation(Level.Stairs, -10.f);
+
+	for (const FHazardsData& HazardsData : Level.Hazards)
+	{
+		BandThresholds.AddUnique(HazardsData.DifficultyFactor);
+	}
+	BandThresholds.Sort();
+
+	const int32 NumBands = FMath::Min(BandThresholds.Num() + 1, 256);
+
+	for (const FHazardsData& HazardsData : Level.Hazards)
+	{
+		// If bSpawnsFrom, the hazard appears from the DifficultyFactor and beyond, otherwise until the DifficultyFactor
+		const int32 Threshold = BandThresholds.IndexOfByKey(HazardsData.DifficultyFactor);
+		const uint8 FirstBand = (uint8)(HazardsData.bSpawnsFrom ? FMath::Min(Threshold + 1, NumBands - 1) : 0);
+		const uint8 LastBand = (uint8)(HazardsData.bSpawnsFrom ? NumBands - 1 : FMath::Min(Threshold, NumBands - 1));
+
+		const AHazard* Hazard = GetHazardDefault(HazardsData.HazardsType);
+		const FVector TileLocation = LevelManager->GetRelativeLocation(HazardsData.Coords, -5.f);
+
+		int32 Count = 0;
+		for (int32 Number = HazardsData.HazardsLocations; Number; Number >>= 1, ++Count)
+		{
+			if (Number & 1)
+			{
+				FRlHazardPlacement& Placement = Hazards.AddDefaulted_GetRef();
+				Placement.Slot = Hazards.Num() - 1;
+				Placement.Type = HazardsData.HazardsType;
+				Placement.FirstBand = FirstBand;
+				Placement.LastBand = LastBand;
+				Hazard->GetPlacement(TileLocation, static_cast<EHazardLocation>(Count), Placement.Location, Placement.Rotation);
+				Placement.DartsDelay = HazardsData.DartsDelay;
+				Placement.DartsCooldown = HazardsData.DartsCooldown;
+				Placement.DartsSpeed = HazardsData.DartsSpeed;
+			}
+		}
+	}
+
+	for (int32 Band = 0; Band < NumBands; ++Band)
+	{
+		BandOffsets.Add(Placements.Num());
+
+		int32 Counts[3] = {};
+		for (const FRlHazardPlacement& Placement : Hazards)
+		{
+			if (Placement.IsInBand(Band))
+			{
+				Placements.Add(Placement);
+				++Counts[(int32)Placement.Type];
+			}
+		}
+
+		MaxSpikes = FMath::Max(MaxSpikes, Counts[(int32)EHazardType::Spikes]);
+		MaxDarts = FMath::Max(MaxDarts, Counts[(int32)EHazardType::Darts]);
+		MaxStones = FMath::Max(MaxStones, Counts[(int32)EHazardType::Stones]);
+	}
+	BandOffsets.Add(Placements.Num());
+
+	for (int32 Slot = 0; Slot < Hazards.Num(); ++Slot)
+	{
+		HazardsByFirstBand.Add(Slot);
+		HazardsByLastBand.Add(Slot);
+	}
+	HazardsByFirstBand.StableSort([this](int32 A, int32 B) { return Hazards[A].FirstBand < Hazards[B].FirstBand; });
+	HazardsByLastBand.StableSort([this](int32 A, int32 B) { return Hazards[A].LastBand < Hazards[B].LastBand; });
+
+	const FTransform Transform = LevelManager->GetLevelTransform();
+	const UPaperTileMap* TileMap = Level.PaperTileMap.LoadSynchronous();
+
+	if (Grid.Build(TileMap, Transform))
+	{
+		const FBox Bounds = TileMap->BodySetup->AggGeom.CalcAABB(Transform);
+		CollisionMinY = Bounds.Min.Y;
+		CollisionMaxY = Bounds.Max.Y;
+
+		bBoxCollision = true;
+		for (int32 Y = 0; Y < Grid.GetHeight() && bBoxCollision; ++Y)
+		{
+			for (int32 X = 0; X < Grid.GetWidth(); ++X)
+			{
+				if (Grid.IsPartial(X, Y))
+				{
+					bBoxCollision = false;
+					break;
+				}
+			}
+		}
+
+		MergeCollisionRects();
+	}
+
+	return TileMap != nullptr;
+}
+
+void FRlLevelBake::MergeCollisionRects()
+{
+	const int32 Width = Grid.GetWidth();
+	const int32 Height = Grid.GetHeight();
+
+	TBitArray<> Used(false, Width * Height);
+
+	auto IsFree = [&](int32 X, int32 Y)
+	{
+		return Grid.IsSolid(X, Y) && !Used[Y * Width + X];
+	};
+
+	// Widest run first, then grow it down while the whole run is solid
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			if (!IsFree(X, Y))
+			{
+				continue;
+			}
+
+			int32 X1 = X;
+			while (X1 + 1 < Width && IsFree(X1 + 1, Y))
+			{
+				++X1;
+			}
+
+			int32 Y1 = Y;
+			for (bool bGrow = true; bGrow && Y1 + 1 < Height; )
+			{
+				for (int32 RunX = X; RunX <= X1; ++RunX)
+				{
+					if (!IsFree(RunX, Y1 + 1))
+					{
+						bGrow = false;
+						break;
+					}
+				}
+
+				if (bGrow)
+				{
+					++Y1;
+				}
+			}
+
+			for (int32 RectY = Y; RectY <= Y1; ++RectY)
+			{
+				for (int32 RectX = X; RectX <= X1; ++RectX)
+				{
+					Used[RectY * Width + RectX] = true;
+				}
+			}
+
+			CollisionRects.Add(Grid.GetCellsBox(X, Y, X1, Y1));
+			X = X1;
+		}
+	}
+}
+
+uint32 FRlLevelBake::ComputeSourceHash(const ULevelManager* LevelManager, int32 LevelIndex)
+{
+	const FRlLevel& Level = LevelManager->Levels[LevelIndex];
+
+	const UPaperTileMap* TileMap = Level.PaperTileMap.LoadSynchronous();
+
+	uint32 Crc = FCrc::StrCrc32(*GetPathNameSafe(TileMap));
+
+	const uint32 Version = FRlLevelBakeFile::Version;
+	HashValue(Crc, Version);
+	HashValue(Crc, LevelManager->SpawnLocation);
+	HashValue(Crc, LevelManager->TileSize);
+	HashValue(Crc, Level.Start);
+	HashValue(Crc, Level.Stairs);
+
+	for (const FHazardsData& HazardsData : Level.Hazards)
+	{
+		HashValue(Crc, HazardsData.Coords);
+		HashValue(Crc, HazardsData.DifficultyFactor);
+		HashValue(Crc, HazardsData.HazardsLocations);
+		HashValue(Crc, HazardsData.HazardsType);
+		HashValue(Crc, HazardsData.DartsDelay);
+		HashValue(Crc, HazardsData.DartsCooldown);
+		HashValue(Crc, HazardsData.DartsSpeed);
+		HashValue(Crc, HazardsData.bSpawnsFrom);
+		HashValue(Crc, GetHazardDefault(HazardsData.HazardsType)->TileSize);
+	}
+
+	if (TileMap)
+	{
+		HashValue(Crc, TileMap->MapWidth);
+		HashValue(Crc, TileMap->MapHeight);
+
+		if (const UBodySetup* BodySetup = TileMap->BodySetup)
+		{
+			const FKAggregateGeom& AggGeom = BodySetup->AggGeom;
+			for (const FKBoxElem& Elem : AggGeom.BoxElems)
+			{
+				HashValue(Crc, Elem.Center);
+				HashValue(Crc, Elem.Rotation);
+				HashValue(Crc, Elem.X);
+				HashValue(Crc, Elem.Y);
+				HashValue(Crc, Elem.Z);
+			}
+
+			HashValue(Crc, AggGeom.ConvexElems.Num());
+			HashValue(Crc, AggGeom.SphereElems.Num());
+			HashValue(Crc, AggGeom.SphylElems.Num());
+		}
+	}
+
+	return Crc;
+}
+
+FArchive& operator<<(FArchive& Ar, FRlLevelBake& LevelBake)
+{
+	Ar << LevelBake.SourceHash;
+	Ar << LevelBake.Start;
+	Ar << LevelBake.Stairs;
+	Ar << LevelBake.BandThresholds;
+	Ar << LevelBake.Placements;
+	Ar << LevelBake.BandOffsets;
+	Ar << LevelBake.Hazards;
+	Ar << LevelBake.HazardsByFirstBand;
+	Ar << LevelBake.HazardsByLastBand;
+	Ar << LevelBake.MaxSpikes;
+	Ar << LevelBake.MaxDarts;
+	Ar << LevelBake.MaxStones;
+	Ar << LevelBake.Grid;
+	Ar << LevelBake.CollisionRects;
+	Ar << LevelBake.CollisionMinY;
+	Ar << LevelBake.CollisionMaxY;
+	Ar << LevelBake.bBoxCollision;
+	return Ar;
+}
+
+FString FRlLevelBakeFile::GetDefaultFilename()
+{
+	return FPaths::ProjectContentDir() / TEXT("Baked/Levels.rlbake");
+}
+
+bool FRlLevelBakeFile::Save(const FString& Filename)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 FileMagic = Magic;
+	uint32 FileVersion = Version;
+	Writer << FileMagic;
+	Writer << FileVersion;
+	Writer << Levels;
+
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+bool FRlLevelBakeFile::Load(const FString& Filename)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	Reader << FileMagic;
+	Reader << FileVersion;
+	if (FileMagic != Magic || FileVersion != Version)
+	{
+		return false;
+	}
+
+	Reader << Levels;
+
+	return !Reader.IsError();
+}
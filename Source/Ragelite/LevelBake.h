@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RLTypes.h"
+#include "CollisionGrid.h"
+#include "Algo/BinarySearch.h"
+
+class ULevelManager;
+
+/** A single hazard of a level, already placed in the world. */
+struct FRlHazardPlacement
+{
+	EHazardType Type;
+
+	/** Difficulty bands where the hazard is placed, both included. */
+	uint8 FirstBand;
+	uint8 LastBand;
+
+	/** Index of the hazard in FRlLevelBake::Hazards, the same in every band. */
+	int32 Slot;
+
+	FVector Location;
+
+	FRotator Rotation;
+
+	float DartsDelay;
+	float DartsCooldown;
+	float DartsSpeed;
+
+	FRlHazardPlacement() : Type(EHazardType::Spikes), FirstBand(0), LastBand(0), Slot(INDEX_NONE), Location(FVector::ZeroVector), Rotation(FRotator::ZeroRotator), DartsDelay(0.f), DartsCooldown(0.f), DartsSpeed(0.f) {};
+
+	bool IsInBand(int32 Band) const { return Band >= FirstBand && Band <= LastBand; }
+
+	friend FArchive& operator<<(FArchive& Ar, FRlHazardPlacement& Placement);
+};
+
+/**
+ * Everything a level transition needs from an FRlLevel, resolved ahead of time:
+ * start and stairs locations, hazard placements per difficulty band and the tile collision.
+ */
+struct RAGELITE_API FRlLevelBake
+{
+	/** Hash of the level data the bake was made from, a mismatch means the bake is stale. */
+	uint32 SourceHash;
+
+	FVector Start;
+
+	FVector Stairs;
+
+	/** Sorted difficulty factors of the hazards. A difficulty belongs to the band of the number of thresholds not above it. */
+	TArray<float> BandThresholds;
+
+	/**
+	 * Placements of every band one after the other, so a band is a single range. A hazard present in several bands is repeated.
+	 * Inside a band they keep the order of the level data, which is the order hazards are taken from the pool.
+	 */
+	TArray<FRlHazardPlacement> Placements;
+
+	/** Start of each band in Placements, plus the end of the last one. */
+	TArray<int32> BandOffsets;
+
+	/** Every hazard of the level once, in the order of the level data. */
+	TArray<FRlHazardPlacement> Hazards;
+
+	/** Slots sorted by first and by last band, so the hazards appearing or disappearing between two bands are two ranges. */
+	TArray<int32> HazardsByFirstBand;
+	TArray<int32> HazardsByLastBand;
+
+	/** Hazards of each type needed by the hardest band for that type. */
+	int32 MaxSpikes;
+	int32 MaxDarts;
+	int32 MaxStones;
+
+	FRlCollisionGrid Grid;
+
+	/** Solid tiles merged into as few XZ rectangles as possible. */
+	TArray<FBox2D> CollisionRects;
+
+	/** Y extent of the tile collision. */
+	float CollisionMinY;
+	float CollisionMaxY;
+
+	/** Every tile with collision is a full box, so the rectangles can replace the tile map collision. */
+	bool bBoxCollision;
+
+	FRlLevelBake();
+
+	int32 GetBand(float Difficulty) const;
+
+	/** Placements of a band, no copy. */
+	TArrayView<const FRlHazardPlacement> GetPlacements(int32 Band) const;
+
+	/** Calls Function with the slot of every hazard present in only one of the two bands. */
+	template<typename FunctionType>
+	void ForEachChangedHazard(int32 OldBand, int32 NewBand, FunctionType Function) const;
+
+	/** Resolves a level of the level manager. Returns false if the level has no tile map, so no collision. */
+	bool Bake(const ULevelManager* LevelManager, int32 LevelIndex);
+
+	static uint32 ComputeSourceHash(const ULevelManager* LevelManager, int32 LevelIndex);
+
+	friend FArchive& operator<<(FArchive& Ar, FRlLevelBake& LevelBake);
+
+private:
+	void MergeCollisionRects();
+};
+
+template<typename FunctionType>
+void FRlLevelBake::ForEachChangedHazard(int32 OldBand, int32 NewBand, FunctionType Function) const
+{
+	const int32 Low = FMath::Min(OldBand, NewBand);
+	const int32 High = FMath::Max(OldBand, NewBand);
+
+	auto GetFirstBand = [this](int32 Slot) { return (int32)Hazards[Slot].FirstBand; };
+	auto GetLastBand = [this](int32 Slot) { return (int32)Hazards[Slot].LastBand; };
+
+	// Only hazards starting in (Low, High] or ending in [Low, High) can change. One doing both is in neither band
+	const int32 FirstBegin = Algo::LowerBoundBy(HazardsByFirstBand, Low + 1, GetFirstBand);
+	const int32 FirstEnd = Algo::UpperBoundBy(HazardsByFirstBand, High, GetFirstBand);
+	const int32 LastBegin = Algo::LowerBoundBy(HazardsByLastBand, Low, GetLastBand);
+	const int32 LastEnd = Algo::LowerBoundBy(HazardsByLastBand, High, GetLastBand);
+
+	for (int32 i = FirstBegin; i < FirstEnd; ++i)
+	{
+		const int32 Slot = HazardsByFirstBand[i];
+		if (Hazards[Slot].IsInBand(OldBand) != Hazards[Slot].IsInBand(NewBand))
+		{
+			Function(Slot);
+		}
+	}
+
+	for (int32 i = LastBegin; i < LastEnd; ++i)
+	{
+		const int32 Slot = HazardsByLastBand[i];
+		if (Hazards[Slot].IsInBand(OldBand) != Hazards[Slot].IsInBand(NewBand))
+		{
+			Function(Slot);
+		}
+	}
+}
+
+/** Bakes of every level, written by the LevelBake commandlet and loaded with the level manager. */
+struct RAGELITE_API FRlLevelBakeFile
+{
+	static const uint32 Magic = 0x424c4c52; // RLLB
+
+	static const uint32 Version = 3;
+
+	TArray<FRlLevelBake> Levels;
+
+	static FString GetDefaultFilename();
+
+	bool Save(const FString& Filename);
+
+	bool Load(const FString& Filename);
+};
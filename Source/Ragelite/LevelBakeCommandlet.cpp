@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LevelBakeCommandlet.h"
+#include "LevelBake.h"
+#include "LevelManager.h"
+#include "RlGameInstance.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLevelBake, Log, All);
+
+ULevelBakeCommandlet::ULevelBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 ULevelBakeCommandlet::Main(const FString& Params)
+{
+	FString Output = FRlLevelBakeFile::GetDefaultFilename();
+	FParse::Value(*Params, TEXT("Output="), Output);
+
+	// The levels live in the Blueprint level manager of the Blueprint game instance
+	FString GameInstanceClassName;
+	GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("GameInstanceClass"), GameInstanceClassName, GEngineIni);
+	UClass* GameInstanceClass = FSoftClassPath(GameInstanceClassName).TryLoadClass<URlGameInstance>();
+	if (!GameInstanceClass)
+	{
+		UE_LOG(LogLevelBake, Error, TEXT("Could not load the game instance class %s"), *GameInstanceClassName);
+		return 1;
+	}
+
+	UClass* LevelManagerClass = GameInstanceClass->GetDefaultObject<URlGameInstance>()->GetLevelManagerClass();
+	if (!LevelManagerClass)
+	{
+		UE_LOG(LogLevelBake, Error, TEXT("%s has no level manager class"), *GameInstanceClassName);
+		return 1;
+	}
+
+	const ULevelManager* LM = LevelManagerClass->GetDefaultObject<ULevelManager>();
+
+	FRlLevelBakeFile BakeFile;
+	BakeFile.Levels.SetNum(LM->Levels.Num());
+
+	for (int32 i = 0; i < LM->Levels.Num(); ++i)
+	{
+		FRlLevelBake& LevelBake = BakeFile.Levels[i];
+		if (!LevelBake.Bake(LM, i))
+		{
+			UE_LOG(LogLevelBake, Warning, TEXT("Level %i has no tile map"), i);
+			continue;
+		}
+
+		UE_LOG(LogLevelBake, Display, TEXT("Level %i: %i hazard placements over %i bands, %ix%i tiles merged into %i rectangles%s"),
+			i, LevelBake.Placements.Num(), LevelBake.BandOffsets.Num() - 1, LevelBake.Grid.GetWidth(), LevelBake.Grid.GetHeight(),
+			LevelBake.CollisionRects.Num(), LevelBake.bBoxCollision ? TEXT("") : TEXT(", keeps the tile map collision"));
+	}
+
+	if (!BakeFile.Save(Output))
+	{
+		UE_LOG(LogLevelBake, Error, TEXT("Could not write %s"), *Output);
+		return 1;
+	}
+
+	UE_LOG(LogLevelBake, Display, TEXT("%i levels written to %s"), BakeFile.Levels.Num(), *Output);
+
+	return 0;
+}
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LevelBakeCommandlet.generated.h"
+
+/**
+ * Bakes every level of the level manager into the file loaded by the game, run it before cooking after editing the levels.
+ *
+ * UE4Editor-Cmd Ragelite -run=LevelBake [-Output=<file>]
+ *
+ * Each level gets its start and stairs locations, its hazard placements for every difficulty band, its collision grid and
+ * its solid tiles merged into rectangles. Writes Content/Baked/Levels.rlbake by default.
+ */
+UCLASS()
+class RAGELITE_API ULevelBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULevelBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LevelCollisionComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+
+URlLevelCollisionComponent::URlLevelCollisionComponent()
+{
+	SetMobility(EComponentMobility::Static);
+	SetHiddenInGame(true);
+	SetCanEverAffectNavigation(false);
+	SetGenerateOverlapEvents(false);
+	bAbsoluteLocation = true;
+	bAbsoluteRotation = true;
+	bAbsoluteScale = true;
+
+	BodySetup = nullptr;
+}
+
+void URlLevelCollisionComponent::SetRectangles(const TArray<FBox2D>& Rectangles, float MinY, float MaxY)
+{
+	if (!BodySetup)
+	{
+		BodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+		BodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		BodySetup->bGenerateMirroredCollision = false;
+	}
+
+	BodySetup->AggGeom.EmptyElements();
+	BodySetup->AggGeom.BoxElems.Reserve(Rectangles.Num());
+
+	for (const FBox2D& Rectangle : Rectangles)
+	{
+		const FVector2D Center = Rectangle.GetCenter();
+		const FVector2D Size = Rectangle.GetSize();
+		BodySetup->AggGeom.BoxElems.Add(FKBoxElem(Size.X, MaxY - MinY, Size.Y));
+		BodySetup->AggGeom.BoxElems.Last().Center = FVector(Center.X, (MinY + MaxY) * 0.5f, Center.Y);
+	}
+
+	BodySetup->InvalidatePhysicsData();
+	BodySetup->CreatePhysicsMeshes();
+
+	UpdateBounds();
+	RecreatePhysicsState();
+}
+
+UBodySetup* URlLevelCollisionComponent::GetBodySetup()
+{
+	return BodySetup;
+}
+
+FBoxSphereBounds URlLevelCollisionComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (BodySetup && BodySetup->AggGeom.GetElementCount())
+	{
+		return FBoxSphereBounds(BodySetup->AggGeom.CalcAABB(LocalToWorld));
+	}
+
+	return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+}
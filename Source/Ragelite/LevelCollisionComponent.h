@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "LevelCollisionComponent.generated.h"
+
+class UBodySetup;
+
+/**
+ * Invisible collision of a level made of a few baked rectangles, used instead of the per tile boxes of the tile map.
+ * Rectangles are in world space, the component stays at the origin.
+ */
+UCLASS()
+class RAGELITE_API URlLevelCollisionComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	URlLevelCollisionComponent();
+
+	/** Replaces the collision with one box per XZ rectangle, from MinY to MaxY. */
+	void SetRectangles(const TArray<FBox2D>& Rectangles, float MinY, float MaxY);
+
+	virtual UBodySetup* GetBodySetup() override;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	UPROPERTY(Transient)
+	UBodySetup* BodySetup;
+};
@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "LevelManager.h"
+#include "Ragelite.h"
 #include "RlGameInstance.h"
 #include "Paper2D/Classes/PaperTileMap.h"
 #include "Paper2D/Classes/PaperTileMapComponent.h"
@@ -19,23 +20,34 @@
 #include "Hazard.h"
 #include "Spike.h"
 #include "HazardPool.h"
+#include "GhostManager.h"
+#include "GhostRun.h"
+#include "LatencyTracer.h"
 #include "RlGameMode.h"
 #include "Paper2D/Classes/PaperFlipbookComponent.h"
 #include "RlGameInstance.h"
 #include "RlSpriteHUD.h"
-#include "Projectile.h"
 #include "InputTutorial.h"
 #include "RlGameMode.h"
 #include "HearRateModule.h"
+#include "SessionRecorder.h"
+#include "InputRecorder.h"
 #include "WidgetManager.h"
+#include "LevelCollisionComponent.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogStatus, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("Level Manager StartLevel"), STAT_RlStartLevel, STATGROUP_Ragelite);
+
 ULevelManager::ULevelManager(const FObjectInitializer& ObjectInitializer)
 {
 	CurrentLevel = nullptr;
+	NextLevel = nullptr;
+	NextLevelIndex = INDEX_NONE;
 	CurrentStairs = nullptr;
+	LevelCollision = nullptr;
 	HazardPool = nullptr;
+	GhostManager = nullptr;
 
 	CurrentLevelIndex = 0;
 
@@ -46,6 +58,8 @@ ULevelManager::ULevelManager(const FObjectInitializer& ObjectInitializer)
 
 	FadeTime = 0.5f;
 
+	ProgressionTable = nullptr;
+
 	static ConstructorHelpers::FObjectFinder<UMaterialInterface> MaterialRef(TEXT("/Game/Materials/MaskedUnlitSpriteMaterial"));
 
 	if (MaterialRef.Object)
@@ -60,6 +74,108 @@ void ULevelManager::Init(URlGameInstance* InRlGameInstance)
 {
 	RlGameInstance = InRlGameInstance;
 	RlGameInstance->OnShutdown.BindUFunction(this, FName("EndGame"));
+
+	LoadLevelBakes();
+	CompileProgression();
+}
+
+void ULevelManager::CompileProgression()
+{
+	TArray<FRlLevelProgressionRow> Rows;
+	if (ProgressionTable && ProgressionTable->GetRowStruct() == FRlLevelProgressionRow::StaticStruct())
+	{
+		ProgressionTable->ForeachRow<FRlLevelProgressionRow>(TEXT("CompileProgression"), [&Rows](const FName& Key, const FRlLevelProgressionRow& Row)
+		{
+			Rows.Add(Row);
+		});
+	}
+	else
+	{
+		if (ProgressionTable)
+		{
+			UE_LOG(LogStatus, Warning, TEXT("%s does not have FRlLevelProgressionRow rows, using the built-in progression"), *ProgressionTable->GetName());
+		}
+
+		// The tutorial levels of the game, one ability each
+		const int32 Unlocks[] = { 0, 1 << (int32)ERlAbility::Run, 1 << (int32)ERlAbility::Jump, 1 << (int32)ERlAbility::LongJump, 1 << (int32)ERlAbility::WallWalk };
+		const ERlInputTutorial Tutorials[] = { ERlInputTutorial::LevelOne, ERlInputTutorial::LevelTwo, ERlInputTutorial::LevelThree, ERlInputTutorial::LevelFour, ERlInputTutorial::LevelTwo };
+		for (int32 i = 0; i < ARRAY_COUNT(Unlocks); ++i)
+		{
+			FRlLevelProgressionRow& Row = Rows.AddDefaulted_GetRef();
+			Row.Level = i + 1;
+			Row.UnlockedAbilities = Unlocks[i];
+			Row.TutorialTileMap = i;
+			Row.TutorialAnimation = Tutorials[i];
+		}
+
+		FRlLevelProgressionRow& Row = Rows.AddDefaulted_GetRef();
+		Row.Level = 6;
+		Row.bEndCalibration = true;
+	}
+
+	Rows.StableSort([](const FRlLevelProgressionRow& A, const FRlLevelProgressionRow& B) { return A.Level < B.Level; });
+
+	Progression.Reset();
+	Progression.SetNum(Levels.Num());
+
+	int32 RowIndex = 0;
+	for (int32 Level = 0; Level < Progression.Num(); ++Level)
+	{
+		FRlLevelProgression& Entry = Progression[Level];
+
+		// Abilities carry over from the previous level, the rest only applies to the level of the row
+		if (Level > 0)
+		{
+			Entry.bSetsAbilities = Progression[Level - 1].bSetsAbilities;
+			Entry.Abilities = Progression[Level - 1].Abilities;
+		}
+
+		for (; RowIndex < Rows.Num() && Rows[RowIndex].Level <= Level; ++RowIndex)
+		{
+			const FRlLevelProgressionRow& Row = Rows[RowIndex];
+			if (Row.Level < 0)
+			{
+				UE_LOG(LogStatus, Warning, TEXT("Ignoring progression row of level %i"), Row.Level);
+				continue;
+			}
+
+			Entry.bSetsAbilities = true;
+			Entry.Abilities |= Row.UnlockedAbilities;
+			Entry.TutorialTileMap = Row.TutorialTileMap;
+			Entry.TutorialAnimation = Row.TutorialAnimation;
+			Entry.bEndCalibration |= Row.bEndCalibration;
+		}
+	}
+}
+
+void ULevelManager::LoadLevelBakes()
+{
+	FRlLevelBakeFile BakeFile;
+	if (!BakeFile.Load(FRlLevelBakeFile::GetDefaultFilename()))
+	{
+		UE_LOG(LogStatus, Log, TEXT("No level bake at %s, baking at startup"), *FRlLevelBakeFile::GetDefaultFilename());
+	}
+
+	LevelBakes = MoveTemp(BakeFile.Levels);
+	LevelBakes.SetNum(Levels.Num());
+
+	// Hashing loads the tile map, so cooked builds trust the bake file and only bake the missing levels
+	const bool bCheckStale = !FPlatformProperties::RequiresCookedData();
+
+	int32 Baked = 0;
+	for (int32 i = 0; i < Levels.Num(); ++i)
+	{
+		if (!LevelBakes[i].SourceHash || (bCheckStale && LevelBakes[i].SourceHash != FRlLevelBake::ComputeSourceHash(this, i)))
+		{
+			LevelBakes[i].Bake(this, i);
+			++Baked;
+		}
+	}
+
+	if (Baked)
+	{
+		UE_LOG(LogStatus, Warning, TEXT("Baked %i stale levels at startup, run the LevelBake commandlet"), Baked);
+	}
 }
 
 UWorld* ULevelManager::GetWorld() const
@@ -101,6 +217,15 @@ void ULevelManager::EndGame()
 		CurrentLevel->Destroy();
 	}
 	CurrentLevel = nullptr;
+	LevelCollision = nullptr;
+	CollisionGrid.Reset();
+
+	if (NextLevel && !NextLevel->IsPendingKill())
+	{
+		NextLevel->Destroy();
+	}
+	NextLevel = nullptr;
+	NextLevelIndex = INDEX_NONE;
 
 	if (InputTutorialTileMapActor && !InputTutorialTileMapActor->IsPendingKill())
 	{
@@ -121,6 +246,12 @@ void ULevelManager::EndGame()
 	}
 	HazardPool = nullptr;
 
+	if (GhostManager && !GhostManager->IsPendingKill())
+	{
+		GhostManager->Destroy();
+	}
+	GhostManager = nullptr;
+
 	if (InputTutorial)
 	{
 		delete InputTutorial;
@@ -148,36 +279,25 @@ void ULevelManager::SetLevel(ELevelState State)
 		UE_LOG(LogStatus, Log, TEXT("Time: %i"), RlGameInstance->Time);
 
 	}
+	if (RlGameInstance->SessionRecorder)
+	{
+		RlGameInstance->SessionRecorder->Record(ERlSessionEvent::Level, CurrentLevelIndex);
+	}
 	if (CurrentLevelIndex < Levels.Num())
 	{
-		if (CurrentLevelIndex == 1)
-		{
-			RlCharacter->bRunEnabled = false;
-			RlCharacter->bJumpEnabled = false;
-			RlCharacter->bLongJumpEnabled = false;
-			RlCharacter->bWallWalkEnabled = false;
-		}
-		if (CurrentLevelIndex == 2)
-		{
-			RlCharacter->bRunEnabled = true;
-		}
-		if (CurrentLevelIndex == 3)
-		{
-			RlCharacter->bJumpEnabled = true;
-		}
-		if (CurrentLevelIndex == 4)
-		{
-			RlCharacter->bLongJumpEnabled = true;
-		}
-		if (CurrentLevelIndex == 5)
+		const FRlLevelProgression& LevelProgression = Progression[CurrentLevelIndex];
+		if (LevelProgression.bSetsAbilities)
 		{
-			RlCharacter->bWallWalkEnabled = true;
+			RlCharacter->bRunEnabled = LevelProgression.HasAbility(ERlAbility::Run);
+			RlCharacter->bJumpEnabled = LevelProgression.HasAbility(ERlAbility::Jump);
+			RlCharacter->bLongJumpEnabled = LevelProgression.HasAbility(ERlAbility::LongJump);
+			RlCharacter->bWallWalkEnabled = LevelProgression.HasAbility(ERlAbility::WallWalk);
 		}
-		if (CurrentLevelIndex == 6)
+		if (LevelProgression.bEndCalibration)
 		{
 			if (ARlGameMode* GameMode = Cast<ARlGameMode>(GetWorld()->GetAuthGameMode()))
 			{
-				if (GameMode->HeartRateModule->bCalibration)
+				if (GameMode->HeartRateModule->Estimator.bCalibration)
 				{
 					GameMode->HeartRateModule->EndCalibration();
 				}
@@ -208,50 +328,90 @@ void ULevelManager::RestartLevel()
 
 void ULevelManager::SetLevelTileMap()
 {
-	if (Levels[CurrentLevelIndex].PaperTileMap && CurrentLevel)
+	if (Levels[CurrentLevelIndex].PaperTileMap.IsNull() || !CurrentLevel)
 	{
-		CurrentLevel->GetRenderComponent()->SetTileMap(Levels[CurrentLevelIndex].PaperTileMap);
+		return;
 	}
+
+	const FRlLevelBake& LevelBake = LevelBakes[CurrentLevelIndex];
+
+	if (NextLevel && NextLevelIndex == CurrentLevelIndex)
+	{
+		Swap(CurrentLevel, NextLevel);
+		SetLevelTileMapActive(NextLevel, false);
+	}
+	else
+	{
+		// Not preloaded yet, or a level that was not next
+		UE_LOG(LogStatus, Log, TEXT("Level %i was not preloaded, loading it now"), CurrentLevelIndex);
+
+		// Disabled before the tile map is set, so the per tile collision is never built
+		SetLevelTileMapActive(CurrentLevel, false);
+		CurrentLevel->GetRenderComponent()->SetTileMap(Levels[CurrentLevelIndex].PaperTileMap.LoadSynchronous());
+	}
+	NextLevelIndex = INDEX_NONE;
+
+	SetLevelTileMapActive(CurrentLevel, true);
+
+	if (LevelBake.bBoxCollision)
+	{
+		LevelCollision->SetRectangles(LevelBake.CollisionRects, LevelBake.CollisionMinY, LevelBake.CollisionMaxY);
+	}
+	else
+	{
+		LevelCollision->SetRectangles(TArray<FBox2D>(), 0.f, 0.f);
+	}
+
+	CollisionGrid = LevelBake.Grid;
+	CollisionGrid.SetComponent(LevelBake.bBoxCollision ? (UPrimitiveComponent*)LevelCollision : CurrentLevel->GetRenderComponent());
+
+	PreloadLevel(CurrentLevelIndex + 1);
 }
 
-void ULevelManager::SpawnObstacles()
+void ULevelManager::SetLevelTileMapActive(APaperTileMapActor* TileMapActor, bool bActive)
 {
-	int32 SpikesNum = 0;
-	int32 DartsNum = 0;
-	int32 StonesNum = 0;
+	UPaperTileMapComponent* TileMapComponent = TileMapActor->GetRenderComponent();
+	TileMapComponent->SetVisibility(bActive);
 
-	for (auto HazardsData : Levels[CurrentLevelIndex].Hazards)
+	if (bActive && !LevelBakes[CurrentLevelIndex].bBoxCollision)
 	{
-		if (HazardsData.HazardsType == EHazardType::Spikes)
-		{
-			SpikesNum += HazardsData.Num();
-		}
-		else if (HazardsData.HazardsType == EHazardType::Darts)
-		{
-			DartsNum += HazardsData.Num();
-		}
-		else if (HazardsData.HazardsType == EHazardType::Stones)
-		{
-			StonesNum += HazardsData.Num();
-		}
+		TileMapComponent->SetCollisionEnabled(GetDefault<UPaperTileMapComponent>()->GetCollisionEnabled());
 	}
-
-	// We have to check the correct amount of spikes
-	while (SpikesNum > HazardPool->Spikes.Num())
+	else
 	{
-		//HazardPool->AddSpikesUntil(Spikes);
-		HazardPool->AddSpikes(HazardPool->InitialSpikes);
+		TileMapComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	}
+}
 
-	while (DartsNum > HazardPool->Darts.Num())
+void ULevelManager::PreloadLevel(int32 LevelIndex)
+{
+	if (!Levels.IsValidIndex(LevelIndex) || Levels[LevelIndex].PaperTileMap.IsNull())
 	{
-		HazardPool->AddDarts(HazardPool->InitialDarts);
+		return;
 	}
 
-	while (StonesNum > HazardPool->Stones.Num())
+	PreloadHandle = StreamableManager.RequestAsyncLoad(Levels[LevelIndex].PaperTileMap.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &ULevelManager::OnLevelPreloaded, LevelIndex));
+}
+
+void ULevelManager::OnLevelPreloaded(int32 LevelIndex)
+{
+	// The game may have ended or moved on while loading
+	if (!NextLevel || LevelIndex != CurrentLevelIndex + 1)
 	{
-		HazardPool->AddStones(HazardPool->InitialStones);
+		return;
 	}
+
+	// Set while hidden and without collision, so the swap only has to show it
+	NextLevel->GetRenderComponent()->SetTileMap(Levels[LevelIndex].PaperTileMap.Get());
+	NextLevelIndex = LevelIndex;
+
+	// The pools grow now rather than on the level change
+	HazardPool->Prewarm(LevelBakes[LevelIndex]);
+}
+
+void ULevelManager::SpawnObstacles()
+{
+	HazardPool->Prewarm(LevelBakes[CurrentLevelIndex]);
 }
 
 void ULevelManager::MoveActors()
@@ -260,46 +420,77 @@ void ULevelManager::MoveActors()
 	ARlCharacter* RlCharacter = Cast<ARlCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
 	RlCharacter->GetRlCharacterMovement()->StopActiveMovement();
 	RlCharacter->GetRlCharacterMovement()->bJustTeleported = true;
-	RlCharacter->SetActorLocation(GetRelativeLocation(Levels[CurrentLevelIndex].Start) - FVector(0.f, 0.f, 4.f));
+	const FRlLevelBake& LevelBake = LevelBakes[CurrentLevelIndex];
 
-	CurrentStairs->SetActorLocation(GetRelativeLocation(Levels[CurrentLevelIndex].Stairs, -10.f));
+	RlCharacter->SetActorLocation(LevelBake.Start);
 
-	HazardPool->ResetHazards(Levels[CurrentLevelIndex].Hazards);
+	CurrentStairs->SetActorLocation(LevelBake.Stairs);
+
+	if (ARlGameMode* GameMode = Cast<ARlGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		HazardPool->ResetHazards(LevelBake, LevelBake.GetBand(GameMode->Difficulty));
+
+		if (RlGameInstance->LatencyTracer)
+		{
+			RlGameInstance->LatencyTracer->OnDifficultyApplied();
+		}
+	}
 }
 
 void ULevelManager::UpdateInputTutorial()
 {
 	ARlCharacter* RlCharacter = Cast<ARlCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
-	InputTutorial->Update(CurrentLevelIndex, RlCharacter->bIsUsingGamepad);
+	InputTutorial->Update(CurrentLevelIndex, Progression[CurrentLevelIndex], RlCharacter->bIsUsingGamepad);
 }
 
-FVector ULevelManager::GetRelativeLocation(FVector2D Coords, int32 Y)
+FVector ULevelManager::GetRelativeLocation(FVector2D Coords, int32 Y) const
 {
 	return FVector(SpawnLocation.X + Coords.X * TileSize, Y, SpawnLocation.Z - Coords.Y * TileSize/* + 4.f*/);
 }
 
+FTransform ULevelManager::GetLevelTransform() const
+{
+	return FTransform(SpawnRotation, SpawnLocation + FVector(-8.f, 0.f, 8.f));
+}
+
 void ULevelManager::StartLevel(ELevelState State)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RlStartLevel);
+
 	if (State == ELevelState::Start)
 	{
 		EndGame();
 
 		//CurrentLevelIndex = 0;
 
-		CurrentStairs = GetWorld()->SpawnActor<AStairs>(GetRelativeLocation(Levels[CurrentLevelIndex].Stairs, -10.f), SpawnRotation, SpawnInfo);
+		CurrentStairs = GetWorld()->SpawnActor<AStairs>(LevelBakes[CurrentLevelIndex].Stairs, SpawnRotation, SpawnInfo);
 
 		UPaperSpriteComponent* CurrentStairsRC = CurrentStairs->GetRenderComponent();
 		CurrentStairsRC->SetSprite(StairsSprite);
 		CurrentStairsRC->SetMaterial(0, Material);
 
-		CurrentLevel = GetWorld()->SpawnActor<APaperTileMapActor>(SpawnLocation + FVector(-8.f, 0.f, 8.f), SpawnRotation, SpawnInfo);
+		CurrentLevel = GetWorld()->SpawnActor<APaperTileMapActor>(GetLevelTransform().GetLocation(), SpawnRotation, SpawnInfo);
 		CurrentLevel->GetRenderComponent()->SetMaterial(0, Material);
 
+		NextLevel = GetWorld()->SpawnActor<APaperTileMapActor>(GetLevelTransform().GetLocation(), SpawnRotation, SpawnInfo);
+		NextLevel->GetRenderComponent()->SetMaterial(0, Material);
+		SetLevelTileMapActive(NextLevel, false);
+
+		LevelCollision = NewObject<URlLevelCollisionComponent>(CurrentLevel);
+		LevelCollision->SetCollisionProfileName(CurrentLevel->GetRenderComponent()->GetCollisionProfileName());
+		LevelCollision->RegisterComponent();
+
 		InputTutorialTileMapActor = GetWorld()->SpawnActor<APaperTileMapActor>(SpawnLocation + FVector(-8.f, 14.f, 0.f), SpawnRotation, SpawnInfo);
 		InputTutorialTileMapActor->GetRenderComponent()->SetMaterial(0, Material);
 
 		HazardPool = GetWorld()->SpawnActor<AHazardPool>(FVector::ZeroVector, SpawnRotation, SpawnInfo);
 
+		if (RlGameInstance->MaxGhosts > 0)
+		{
+			GhostManager = GetWorld()->SpawnActor<AGhostManager>(FVector::ZeroVector, SpawnRotation, SpawnInfo);
+			GhostManager->LoadRuns(RlGameInstance->MaxGhosts);
+		}
+
 
 		InputTutorial = NewObject<UInputTutorial>();
 		InputTutorial->Init(InputTutorialTileMapActor, InputTutorialTileMaps, RlGameInstance);
@@ -318,7 +509,25 @@ void ULevelManager::StartLevel(ELevelState State)
 		}
 	}
 
-	DestroyProjectiles();
+	ReleaseProjectiles();
+
+	if (RlGameInstance->InputRecorder)
+	{
+		if (ARlGameMode* GameMode = Cast<ARlGameMode>(GetWorld()->GetAuthGameMode()))
+		{
+			RlGameInstance->InputRecorder->BeginSegment(CurrentLevelIndex, GameMode->Difficulty);
+		}
+	}
+
+	if (RlGameInstance->GhostRecorder)
+	{
+		RlGameInstance->GhostRecorder->BeginSegment(CurrentLevelIndex);
+	}
+
+	if (GhostManager)
+	{
+		GhostManager->StartLevel(CurrentLevelIndex);
+	}
 
 	MoveActors();
 
@@ -373,12 +582,10 @@ void ULevelManager::FadeOutCallback()
 	RlCharacter->bInvincible = false;
 }
 
-void ULevelManager::DestroyProjectiles()
+void ULevelManager::ReleaseProjectiles()
 {
-	TArray<AActor*> Projectiles;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AProjectile::StaticClass(), Projectiles);
-	for (AActor* Projectile : Projectiles)
+	if (HazardPool)
 	{
-		Projectile->Destroy();
+		HazardPool->ReleaseProjectiles();
 	}
 }
\ No newline at end of file
@@ -6,7 +6,9 @@
 #include "UObject/NoExportTypes.h"
 #include "TimerManager.h"
 #include "RLTypes.h"
+#include "LevelBake.h"
 #include "Engine/World.h"
+#include "Engine/StreamableManager.h"
 #include "LevelManager.generated.h"
 
 
@@ -21,9 +23,12 @@ class UWorld;
 class AStairs;
 class UPrimitiveComponent;
 class AHazardPool;
+class AGhostManager;
 class ARlSpikes;
 class UInputTutorial;
+class URlLevelCollisionComponent;
 class UUserWidget;
+class UDataTable;
 
 /**
  * 
@@ -51,6 +56,10 @@ public:
 	UPROPERTY(Category = Levels, EditAnywhere)
 	TArray<FRlLevel> Levels;
 
+	/** FRlLevelProgressionRow rows: ability unlocks, input tutorial and calibration per level. The built-in progression is used without one. */
+	UPROPERTY(Category = Levels, EditAnywhere)
+	UDataTable* ProgressionTable;
+
 	UPROPERTY(Category = Sprites, EditAnywhere)
 	UPaperSprite* StairsSprite;
 
@@ -85,10 +94,28 @@ public:
 
 	APaperTileMapActor* CurrentLevel;
 
+	/** Back buffer of CurrentLevel, hidden and without collision. Holds the next level once it is preloaded, so SetLevel(Next) swaps the two. */
+	APaperTileMapActor* NextLevel;
+
+	/** Level set on NextLevel, INDEX_NONE while its tile map is loading. */
+	int32 NextLevelIndex;
+
 	APaperTileMapActor* InputTutorialTileMapActor;
 
 	AHazardPool* HazardPool;
 
+	/** Plays past attempts of the current level, null unless ghosts are enabled with -ghosts=<count>. */
+	AGhostManager* GhostManager;
+
+	/** Occupancy of the current level, copied from the level bake when the tile map changes and updated when the hazards move. */
+	FRlCollisionGrid CollisionGrid;
+
+	/** One per level, loaded from the LevelBake commandlet output. Levels missing from it or changed since are baked on Init. */
+	TArray<FRlLevelBake> LevelBakes;
+
+	/** One per level, compiled from the progression table on Init. */
+	TArray<FRlLevelProgression> Progression;
+
 	UPROPERTY()
 	UInputTutorial* InputTutorial;
 
@@ -102,7 +129,16 @@ public:
 	void RestartLevel();
 
 
-	FVector GetRelativeLocation(FVector2D Coords, int32 Y = 0.f);
+	FVector GetRelativeLocation(FVector2D Coords, int32 Y = 0.f) const;
+
+	/** Transform of the level tile map actor. */
+	FTransform GetLevelTransform() const;
+
+	/** Loads the level bakes, baking again the stale ones. */
+	void LoadLevelBakes();
+
+	/** Flattens the progression table into one entry per level. */
+	void CompileProgression();
 
 	void UpdateInputTutorial();
 
@@ -114,6 +150,9 @@ private:
 
 	AStairs* CurrentStairs;
 
+	/** Replaces the tile map collision on levels with box only collision. */
+	URlLevelCollisionComponent* LevelCollision;
+
 	UFUNCTION()
 	void StartLevel(ELevelState State);
 
@@ -122,12 +161,25 @@ private:
 	void SpawnObstacles();
 	void MoveActors();
 
+	FStreamableManager StreamableManager;
+
+	/** Keeps the tile map of the preloaded level loaded. */
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+
+	/** Streams the tile map of a level in the background and sets it on NextLevel once loaded. */
+	void PreloadLevel(int32 LevelIndex);
+
+	void OnLevelPreloaded(int32 LevelIndex);
+
+	/** Hides a tile map actor and disables its collision, or shows it with the collision the level needs. */
+	void SetLevelTileMapActive(APaperTileMapActor* TileMapActor, bool bActive);
+
 	FTimerHandle FadeTimerHandle;
 	void FadeIn(FTimerDelegate TimerDelegate);
 	void FadeOut();
 	void FadeOutCallback();
 
-	void DestroyProjectiles();
+	void ReleaseProjectiles();
 
 	bool bTimeStarted;
 };
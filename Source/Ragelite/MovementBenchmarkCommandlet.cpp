@@ -0,0 +1,289 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MovementBenchmarkCommandlet.h"
+#include "MovementProfiler.h"
+#include "RlCharacter.h"
+#include "RlCharacterMovementComponent.h"
+#include "RlGameInstance.h"
+#include "RlGameMode.h"
+#include "LevelManager.h"
+#include "HazardPool.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "PaperFlipbookComponent.h"
+#include "Paper2D/Classes/PaperTileMapComponent.h"
+#include "Paper2D/Classes/PaperTileMapActor.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMovementBenchmark, Log, All);
+
+namespace
+{
+	struct FLevelResult
+	{
+		int32 LevelIndex;
+		int32 Ticks;
+		int32 Deaths;
+		uint64 TotalCycles;
+		uint64 Cycles[(int32)ERlMovementPhase::Num];
+		uint32 Calls[(int32)ERlMovementPhase::Num];
+		uint32 Sweeps;
+		uint32 Moves;
+		int32 ModeTicks[3];
+	};
+
+	/** Input for one tick of the script, in seconds so it does not depend on the tick rate. */
+	struct FScriptedInput
+	{
+		float MoveRight;
+		bool bJump;
+		bool bSprint;
+	};
+
+	FScriptedInput GetScriptedInput(float Time)
+	{
+		FScriptedInput Input;
+
+		// Turn around every 2 s, jump every 0.6 s holding it a variable time, sprint every other 4 s
+		Input.MoveRight = FMath::Fmod(Time, 4.f) < 2.f ? 1.f : -1.f;
+		Input.bJump = FMath::Fmod(Time, 0.6f) < 0.1f + 0.05f * (FMath::FloorToInt(Time / 0.6f) % 4);
+		Input.bSprint = FMath::Fmod(Time, 8.f) >= 4.f;
+
+		return Input;
+	}
+
+	/** Same as ULevelManager::MoveActors and the revive in ULevelManager::StartLevel, without a player controller. */
+	void ResetCharacter(ARlCharacter* Character, const FVector& Start)
+	{
+		Character->GetWorldTimerManager().ClearTimer(Character->DeathHandle);
+
+		if (Character->bDeath)
+		{
+			Character->bDeath = false;
+			Character->GetSprite()->ToggleVisibility();
+		}
+		Character->ResetJumpState();
+
+		URlCharacterMovementComponent* Movement = Character->GetRlCharacterMovement();
+		Movement->StopActiveMovement();
+		Movement->bJustTeleported = true;
+		Character->SetActorLocation(Start);
+	}
+
+	double CyclesToNanoseconds(uint64 Cycles)
+	{
+		return Cycles * FPlatformTime::GetSecondsPerCycle64() * 1e9;
+	}
+}
+
+UMovementBenchmarkCommandlet::UMovementBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UMovementBenchmarkCommandlet::Main(const FString& Params)
+{
+#if !RL_MOVEMENT_PROFILER
+	UE_LOG(LogMovementBenchmark, Error, TEXT("The movement profiler is compiled out of this build"));
+	return 1;
+#else
+	int32 Ticks = 10000;
+	FParse::Value(*Params, TEXT("Ticks="), Ticks);
+
+	int32 TickRate = 120;
+	FParse::Value(*Params, TEXT("TickRate="), TickRate);
+
+	float Difficulty = 0.5f;
+	FParse::Value(*Params, TEXT("Difficulty="), Difficulty);
+
+	int32 OnlyLevel = INDEX_NONE;
+	FParse::Value(*Params, TEXT("Level="), OnlyLevel);
+
+	FString Output = FPaths::ProjectSavedDir() / TEXT("MovementBenchmark");
+	FParse::Value(*Params, TEXT("Output="), Output);
+
+	const bool bUseCollisionGrid = !FParse::Param(*Params, TEXT("NoCollisionGrid"));
+
+	// The levels and sprites live in the Blueprint game instance
+	FString GameInstanceClassName;
+	GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("GameInstanceClass"), GameInstanceClassName, GEngineIni);
+	UClass* GameInstanceClass = FSoftClassPath(GameInstanceClassName).TryLoadClass<URlGameInstance>();
+	if (!GameInstanceClass)
+	{
+		UE_LOG(LogMovementBenchmark, Error, TEXT("Could not load the game instance class %s"), *GameInstanceClassName);
+		return 1;
+	}
+
+	URlGameInstance* RlGI = NewObject<URlGameInstance>(GEngine, GameInstanceClass);
+	RlGI->AddToRoot();
+	RlGI->bUseDevice = false;
+	RlGI->bDynamicDifficulty = false;
+	RlGI->bIntro = false;
+	RlGI->bRecordSession = false;
+	RlGI->InitializeStandalone();
+
+	UWorld* World = RlGI->GetWorld();
+	World->SetGameMode(FURL());
+
+	if (ARlGameMode* GameMode = Cast<ARlGameMode>(World->GetAuthGameMode()))
+	{
+		GameMode->Difficulty = Difficulty;
+	}
+
+	ULevelManager* LM = RlGI->LevelManager;
+
+	FRotator SpawnRotation(0.f);
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	APaperTileMapActor* TileMapActor = World->SpawnActor<APaperTileMapActor>(LM->GetLevelTransform().GetLocation(), SpawnRotation, SpawnInfo);
+	AHazardPool* HazardPool = World->SpawnActor<AHazardPool>(FVector::ZeroVector, SpawnRotation, SpawnInfo);
+	ARlCharacter* Character = World->SpawnActor<ARlCharacter>(LM->SpawnLocation, SpawnRotation, SpawnInfo);
+
+	// Only the movement ticks, straight from the loop below
+	URlCharacterMovementComponent* Movement = Character->GetRlCharacterMovement();
+	Movement->bRunPhysicsWithNoController = true;
+	Movement->bUseFixedTimeStep = false;
+	Movement->bUseCollisionGrid = bUseCollisionGrid;
+
+	const float DeltaTime = 1.f / FMath::Max(TickRate, 1);
+
+	TArray<FLevelResult> Results;
+
+	for (int32 LevelIndex = 0; LevelIndex < LM->Levels.Num(); ++LevelIndex)
+	{
+		const FRlLevel& Level = LM->Levels[LevelIndex];
+		if (Level.PaperTileMap.IsNull() || (OnlyLevel != INDEX_NONE && OnlyLevel != LevelIndex))
+		{
+			continue;
+		}
+
+		const FRlLevelBake& LevelBake = LM->LevelBakes[LevelIndex];
+
+		// Keeps the tile map collision, only the grid and the hazards come from the bake
+		TileMapActor->GetRenderComponent()->SetTileMap(Level.PaperTileMap.LoadSynchronous());
+		LM->CollisionGrid = LevelBake.Grid;
+		LM->CollisionGrid.SetComponent(TileMapActor->GetRenderComponent());
+
+		HazardPool->Prewarm(LevelBake);
+		HazardPool->ResetHazards(LevelBake, LevelBake.GetBand(Difficulty));
+
+		ResetCharacter(Character, LevelBake.Start);
+
+		FLevelResult& Result = Results.AddZeroed_GetRef();
+		Result.LevelIndex = LevelIndex;
+		Result.Ticks = Ticks;
+
+		FScriptedInput PreviousInput = {};
+
+		FRlMovementProfiler::Reset();
+		FRlMovementProfiler::bEnabled = true;
+
+		for (int32 Tick = 0; Tick < Ticks; ++Tick)
+		{
+			const FScriptedInput Input = GetScriptedInput(Tick * DeltaTime);
+
+			if (Input.bSprint && !PreviousInput.bSprint)
+			{
+				Character->Sprint();
+			}
+			else if (!Input.bSprint && PreviousInput.bSprint)
+			{
+				Character->StopSprinting();
+			}
+
+			if (Input.bJump && !PreviousInput.bJump)
+			{
+				Character->Jump(FKey());
+			}
+			else if (!Input.bJump && PreviousInput.bJump)
+			{
+				Character->StopJumping();
+			}
+			Character->MoveRight(Input.MoveRight);
+			PreviousInput = Input;
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Movement->TickComponent(DeltaTime, LEVELTICK_All, &Movement->PrimaryComponentTick);
+			Result.TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			switch (Movement->MovementMode)
+			{
+			case ERlMovementMode::Walking:
+				Result.ModeTicks[0]++;
+				break;
+			case ERlMovementMode::Falling:
+				Result.ModeTicks[1]++;
+				break;
+			case ERlMovementMode::WallWalking:
+				Result.ModeTicks[2]++;
+				break;
+			default:
+				break;
+			}
+
+			if (Character->bDeath)
+			{
+				Result.Deaths++;
+				ResetCharacter(Character, Start);
+			}
+		}
+
+		FRlMovementProfiler::bEnabled = false;
+
+		FMemory::Memcpy(Result.Cycles, FRlMovementProfiler::Cycles, sizeof(Result.Cycles));
+		FMemory::Memcpy(Result.Calls, FRlMovementProfiler::Calls, sizeof(Result.Calls));
+		Result.Sweeps = FRlMovementProfiler::Sweeps;
+		Result.Moves = FRlMovementProfiler::Moves;
+	}
+
+	FString Header = TEXT("Level,Ticks,Deaths,WalkingTicks,FallingTicks,WallWalkingTicks,TotalNsPerTick");
+	for (int32 Phase = 0; Phase < (int32)ERlMovementPhase::Num; ++Phase)
+	{
+		const TCHAR* PhaseName = FRlMovementProfiler::GetPhaseName((ERlMovementPhase)Phase);
+		Header += FString::Printf(TEXT(",%sNsPerTick,%sCallsPerTick"), PhaseName, PhaseName);
+	}
+	Header += TEXT(",SweepsPerTick,MovesPerTick\n");
+
+	FString Csv = Header;
+	for (const FLevelResult& Result : Results)
+	{
+		const double TickCount = FMath::Max(Result.Ticks, 1);
+
+		UE_LOG(LogMovementBenchmark, Display, TEXT("Level %i: %.0f ns/tick, %.2f sweeps/tick, %.2f moves/tick, %i deaths (walking %i, falling %i, wall walking %i ticks)"),
+			Result.LevelIndex, CyclesToNanoseconds(Result.TotalCycles) / TickCount, Result.Sweeps / TickCount, Result.Moves / TickCount, Result.Deaths,
+			Result.ModeTicks[0], Result.ModeTicks[1], Result.ModeTicks[2]);
+
+		Csv += FString::Printf(TEXT("%i,%i,%i,%i,%i,%i,%f"), Result.LevelIndex, Result.Ticks, Result.Deaths,
+			Result.ModeTicks[0], Result.ModeTicks[1], Result.ModeTicks[2], CyclesToNanoseconds(Result.TotalCycles) / TickCount);
+
+		for (int32 Phase = 0; Phase < (int32)ERlMovementPhase::Num; ++Phase)
+		{
+			const double PhaseNs = CyclesToNanoseconds(Result.Cycles[Phase]) / TickCount;
+			UE_LOG(LogMovementBenchmark, Display, TEXT("    %-16s %8.0f ns/tick %6.2f calls/tick"), FRlMovementProfiler::GetPhaseName((ERlMovementPhase)Phase), PhaseNs, Result.Calls[Phase] / TickCount);
+
+			Csv += FString::Printf(TEXT(",%f,%f"), PhaseNs, Result.Calls[Phase] / TickCount);
+		}
+
+		Csv += FString::Printf(TEXT(",%f,%f\n"), Result.Sweeps / TickCount, Result.Moves / TickCount);
+	}
+
+	FFileHelper::SaveStringToFile(Csv, *(Output / TEXT("MovementBenchmark.csv")));
+	UE_LOG(LogMovementBenchmark, Display, TEXT("Results written to %s"), *Output);
+
+	LM->CollisionGrid.Reset();
+	RlGI->Shutdown();
+	World->DestroyWorld(false);
+	GEngine->DestroyWorldContext(World);
+	RlGI->RemoveFromRoot();
+
+	return 0;
+#endif
+}
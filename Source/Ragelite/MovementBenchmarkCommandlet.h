@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MovementBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the character movement on every level tile map without rendering and reports the cost of each movement phase.
+ *
+ * UE4Editor-Cmd Ragelite -run=MovementBenchmark [-Ticks=10000] [-TickRate=120] [-Difficulty=0.5] [-Level=<index>] [-NoCollisionGrid] [-Output=<directory>]
+ *
+ * A character is spawned at the start of each level and driven by a fixed input script (run, sprint, jump, turn around),
+ * ticking only its movement component. Reports ns/tick for PhysWalking, PhysFalling, PhysWallWalking, FindFloor,
+ * ComputeFloorDist and CheckSpikes, plus collision queries per tick, and writes MovementBenchmark.csv to the output directory.
+ */
+UCLASS()
+class RAGELITE_API UMovementBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMovementBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
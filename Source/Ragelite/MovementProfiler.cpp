@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MovementProfiler.h"
+
+DEFINE_STAT(STAT_RlMovement_PhysWalking);
+DEFINE_STAT(STAT_RlMovement_PhysFalling);
+DEFINE_STAT(STAT_RlMovement_PhysWallWalking);
+DEFINE_STAT(STAT_RlMovement_FindFloor);
+DEFINE_STAT(STAT_RlMovement_ComputeFloorDist);
+DEFINE_STAT(STAT_RlMovement_CheckSpikes);
+
+bool FRlMovementProfiler::bEnabled = false;
+uint64 FRlMovementProfiler::Cycles[(int32)ERlMovementPhase::Num] = {};
+uint32 FRlMovementProfiler::Calls[(int32)ERlMovementPhase::Num] = {};
+uint32 FRlMovementProfiler::Sweeps = 0;
+uint32 FRlMovementProfiler::Moves = 0;
+
+void FRlMovementProfiler::Reset()
+{
+	FMemory::Memzero(Cycles);
+	FMemory::Memzero(Calls);
+	Sweeps = 0;
+	Moves = 0;
+}
+
+const TCHAR* FRlMovementProfiler::GetPhaseName(ERlMovementPhase Phase)
+{
+	switch (Phase)
+	{
+	case ERlMovementPhase::PhysWalking:
+		return TEXT("PhysWalking");
+	case ERlMovementPhase::PhysFalling:
+		return TEXT("PhysFalling");
+	case ERlMovementPhase::PhysWallWalking:
+		return TEXT("PhysWallWalking");
+	case ERlMovementPhase::FindFloor:
+		return TEXT("FindFloor");
+	case ERlMovementPhase::ComputeFloorDist:
+		return TEXT("ComputeFloorDist");
+	case ERlMovementPhase::CheckSpikes:
+		return TEXT("CheckSpikes");
+	default:
+		return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Ragelite.h"
+
+/** Compiled out of shipping builds, at runtime it only costs a branch until FRlMovementProfiler::bEnabled is set. */
+#ifndef RL_MOVEMENT_PROFILER
+#define RL_MOVEMENT_PROFILER !UE_BUILD_SHIPPING
+#endif
+
+/** Instrumented phases of URlCharacterMovementComponent. Times are inclusive, PhysWalking contains FindFloor, which contains ComputeFloorDist. */
+enum class ERlMovementPhase : uint8
+{
+	PhysWalking,
+	PhysFalling,
+	PhysWallWalking,
+	FindFloor,
+	ComputeFloorDist,
+	CheckSpikes,
+	Num
+};
+
+/**
+ * Accumulates cycles and calls per movement phase, plus the collision queries issued by the movement.
+ * Game thread only, used by the movement benchmark.
+ */
+struct RAGELITE_API FRlMovementProfiler
+{
+	static bool bEnabled;
+
+	static uint64 Cycles[(int32)ERlMovementPhase::Num];
+
+	static uint32 Calls[(int32)ERlMovementPhase::Num];
+
+	/** Scene queries: floor sweeps and spike traces. */
+	static uint32 Sweeps;
+
+	/** Swept moves of the updated component. */
+	static uint32 Moves;
+
+	static void Reset();
+
+	static const TCHAR* GetPhaseName(ERlMovementPhase Phase);
+};
+
+class FRlMovementProfilerScope
+{
+public:
+	FORCEINLINE FRlMovementProfilerScope(ERlMovementPhase InPhase)
+		: Phase(InPhase)
+		, StartCycles(FRlMovementProfiler::bEnabled ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	FORCEINLINE ~FRlMovementProfilerScope()
+	{
+		if (StartCycles)
+		{
+			FRlMovementProfiler::Cycles[(int32)Phase] += FPlatformTime::Cycles64() - StartCycles;
+			FRlMovementProfiler::Calls[(int32)Phase]++;
+		}
+	}
+
+private:
+	ERlMovementPhase Phase;
+
+	uint64 StartCycles;
+};
+
+// The phases also show in "stat Ragelite", in any build with stats
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement PhysWalking"), STAT_RlMovement_PhysWalking, STATGROUP_Ragelite, RAGELITE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement PhysFalling"), STAT_RlMovement_PhysFalling, STATGROUP_Ragelite, RAGELITE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement PhysWallWalking"), STAT_RlMovement_PhysWallWalking, STATGROUP_Ragelite, RAGELITE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement FindFloor"), STAT_RlMovement_FindFloor, STATGROUP_Ragelite, RAGELITE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement ComputeFloorDist"), STAT_RlMovement_ComputeFloorDist, STATGROUP_Ragelite, RAGELITE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement CheckSpikes"), STAT_RlMovement_CheckSpikes, STATGROUP_Ragelite, RAGELITE_API);
+
+#if RL_MOVEMENT_PROFILER
+#define RL_MOVEMENT_PHASE(Phase) SCOPE_CYCLE_COUNTER(STAT_RlMovement_##Phase); FRlMovementProfilerScope MovementProfilerScope_##Phase(ERlMovementPhase::Phase)
+#define RL_MOVEMENT_SWEEP() FRlMovementProfiler::Sweeps += FRlMovementProfiler::bEnabled
+#define RL_MOVEMENT_MOVE() FRlMovementProfiler::Moves += FRlMovementProfiler::bEnabled
+#else
+#define RL_MOVEMENT_PHASE(Phase) SCOPE_CYCLE_COUNTER(STAT_RlMovement_##Phase)
+#define RL_MOVEMENT_SWEEP()
+#define RL_MOVEMENT_MOVE()
+#endif
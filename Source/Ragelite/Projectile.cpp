@@ -8,6 +8,8 @@
 #include "RlCharacter.h"
 #include "TimerManager.h"
 #include "Engine/World.h"
+#include "RlGameInstance.h"
+#include "LevelManager.h"
 
 AProjectile::AProjectile()
 {
@@ -23,41 +25,67 @@ AProjectile::AProjectile()
 	InRenderComponent->OnComponentHit.AddDynamic(this, &AProjectile::OnHit);
 
 	InitialSpeed = 100.f;
+	ManagerIndex = INDEX_NONE;
 
-	PrimaryActorTick.bCanEverTick = true;
+	// Moved by AProjectileManager
+	PrimaryActorTick.bCanEverTick = false;
+	MovementComponent->PrimaryComponentTick.bCanEverTick = false;
 }
 
-void AProjectile::Tick(float DeltaSeconds)
+void AProjectile::BeginPlay()
 {
-	if (GetWorld()->GetTimerManager().IsTimerActive(DestroyHandle))
+	Super::BeginPlay();
+}
+
+void AProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
+	{
+		RlGI->LevelManager->CollisionGrid.RemoveDynamic(GetRenderComponent());
+	}
+}
+
+void AProjectile::Launch(float Speed)
+{
+	InitialSpeed = Speed;
+	MovementComponent->Velocity = GetActorUpVector() * Speed;
+	GetRenderComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	// Moving, the collision grid tests it on every query
+	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
 	{
-		return;
+		RlGI->LevelManager->CollisionGrid.AddDynamic(GetRenderComponent());
 	}
-	const FVector Delta = GetActorUpVector() * InitialSpeed * DeltaSeconds;
-
-	FHitResult Hit(1.f);
-	MovementComponent->SafeMoveUpdatedComponent(Delta, RootComponent->GetComponentQuat(), true, Hit);
-	
-	//float LastMoveTimeSlice = DeltaSeconds;
-	//
-	if (Hit.bBlockingHit)
+}
+
+void AProjectile::Land()
+{
+	MovementComponent->Velocity = FVector::ZeroVector;
+	GetRenderComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void AProjectile::Stop()
+{
+	MovementComponent->Velocity = FVector::ZeroVector;
+
+	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
 	{
-		MovementComponent->Velocity = FVector::ZeroVector;
-		GetRenderComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		RlGI->LevelManager->CollisionGrid.RemoveDynamic(GetRenderComponent());
+	}
+}
 
-		GetWorld()->GetTimerManager().SetTimer(DestroyHandle, this, &AProjectile::DestroyWrapper, 1.f, false);
+void AProjectile::Release()
+{
+	if (OnRelease.IsBound())
+	{
+		OnRelease.Execute(this);
+	}
+	else
+	{
+		Destroy();
 	}
-	//
-	//if (Hit.bStartPenetrating)
-	//{
-	//	// Allow this hit to be used as an impact we can deflect off, otherwise we do nothing the rest of the update and appear to hitch.
-	//	SlideAlongSurface(Delta, 1.f, Hit.Normal, Hit, true);
-	//
-	//	if (Hit.bStartPenetrating)
-	//	{
-	//		OnCharacterStuckInGeometry(&Hit);
-	//	}
-	//}
 }
 
 void AProjectile::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -70,11 +98,6 @@ void AProjectile::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, U
 		}
 		OnRlCharacterHit.ExecuteIfBound();
 
-		Destroy();
+		Release();
 	}
 }
-
-void AProjectile::DestroyWrapper()
-{
-	Destroy();
-}
@@ -7,6 +7,7 @@
 #include "Projectile.generated.h"
 
 DECLARE_DELEGATE(FHitSignature)
+DECLARE_DELEGATE_OneParam(FProjectileReleaseSignature, AProjectile*)
 
 //class UProjectileMovementComponent;
 class UDefaultMovementComponent;
@@ -22,7 +23,21 @@ class RAGELITE_API AProjectile : public APaperSpriteActor
 public:
 	AProjectile();
 
-	virtual void Tick(float DeltaSeconds) override;
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Enables the collision and joins the collision grid, called when taken from the pool. The projectile manager moves it. */
+	void Launch(float Speed);
+
+	/** Disables the collision once stuck in a wall. */
+	void Land();
+
+	/** Leaves the collision grid, called when going back to the pool. */
+	void Stop();
+
+	/** Returns the projectile to its pool, or destroys it if it has none. */
+	void Release();
 
 	UPROPERTY(Category = Character, VisibleAnywhere, meta = (AllowPrivateAccess = "true"))
 	UDefaultMovementComponent* MovementComponent;
@@ -30,14 +45,15 @@ public:
 
 	FHitSignature OnRlCharacterHit;
 
-	FTimerHandle DestroyHandle;
+	FProjectileReleaseSignature OnRelease;
 
 	float InitialSpeed;
 
+	/** Slot in the projectile manager, INDEX_NONE when it is not managed. */
+	int32 ManagerIndex;
+
 private:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
-
-	void DestroyWrapper();
 	
 };
@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileManager.h"
+#include "Ragelite.h"
+#include "Projectile.h"
+#include "RlGameInstance.h"
+#include "LevelManager.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Paper2D/Classes/PaperSpriteComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Manager Tick"), STAT_RlProjectileManagerTick, STATGROUP_Ragelite);
+
+AProjectileManager::AProjectileManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	StuckTime = 1.f;
+	MaxFlightTime = 10.f;
+
+	bTicking = false;
+}
+
+AProjectile* AProjectileManager::Fire(const FVector& Location, const FRotator& Rotation, float Speed)
+{
+	AProjectile* Projectile = Pool.Acquire(Location, Rotation);
+	Projectile->Launch(Speed);
+	Add(Projectile);
+	return Projectile;
+}
+
+void AProjectileManager::Release(AProjectile* Projectile)
+{
+	Pool.Release(Projectile);
+}
+
+void AProjectileManager::ReleaseAll()
+{
+	Pool.ReleaseAll();
+}
+
+void AProjectileManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
+
+	Pool.Init(this);
+	Pool.OnSpawned = [this, LM](AProjectile* Projectile)
+	{
+		UPaperSpriteComponent* RenderComponent = Projectile->GetRenderComponent();
+		RenderComponent->SetSprite(LM->GetDartSprite());
+		RenderComponent->SetMaterial(0, LM->Material);
+		Projectile->OnRelease.BindUObject(this, &AProjectileManager::Release);
+	};
+	Pool.OnReleased = [this](AProjectile* Projectile)
+	{
+		Remove(Projectile);
+		Projectile->Stop();
+	};
+}
+
+void AProjectileManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RlProjectileManagerTick);
+
+	Super::Tick(DeltaSeconds);
+
+	const int32 Count = Projectiles.Num();
+	if (!Count)
+	{
+		return;
+	}
+
+	bTicking = true;
+
+	// Integration, no branches so it vectorizes
+	TargetX.SetNumUninitialized(Count, false);
+	TargetZ.SetNumUninitialized(Count, false);
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		TargetX[i] = PositionX[i] + VelocityX[i] * DeltaSeconds;
+		TargetZ[i] = PositionZ[i] + VelocityZ[i] * DeltaSeconds;
+		Lifetime[i] -= DeltaSeconds;
+	}
+
+	// The character is not in the grid, one box for all the projectiles
+	FBox2D CharacterBox(ForceInit);
+	if (APawn* Pawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0))
+	{
+		const FBox Bounds = Pawn->GetRootComponent()->Bounds.GetBox();
+		CharacterBox = FBox2D(FVector2D(Bounds.Min.X, Bounds.Min.Z), FVector2D(Bounds.Max.X, Bounds.Max.Z));
+	}
+
+	const FRlCollisionGrid& Grid = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager->CollisionGrid;
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		if (!Projectiles[i])
+		{
+			continue;
+		}
+
+		if (Lifetime[i] <= 0.f)
+		{
+			Projectiles[i]->Release();
+			continue;
+		}
+
+		if (VelocityX[i] == 0.f && VelocityZ[i] == 0.f)
+		{
+			continue;
+		}
+
+		const FVector2D Extent(ExtentX[i], ExtentZ[i]);
+		FBox2D SweptBox(FVector2D(PositionX[i], PositionZ[i]) - Extent, FVector2D(PositionX[i], PositionZ[i]) + Extent);
+		SweptBox += FBox2D(FVector2D(TargetX[i], TargetZ[i]) - Extent, FVector2D(TargetX[i], TargetZ[i]) + Extent);
+
+		const FVector Target(TargetX[i], PositionY[i], TargetZ[i]);
+
+		if (Grid.Overlap(SweptBox, true) == ERlGridResult::Clear && !(CharacterBox.bIsValid && CharacterBox.Intersect(SweptBox)))
+		{
+			Projectiles[i]->SetActorLocation(Target);
+			PositionX[i] = TargetX[i];
+			PositionZ[i] = TargetZ[i];
+		}
+		else
+		{
+			SweepProjectile(i, Target);
+		}
+	}
+
+	bTicking = false;
+
+	RemoveReleased();
+}
+
+void AProjectileManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	Pool.DestroyAll();
+
+	Projectiles.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	VelocityX.Reset();
+	VelocityZ.Reset();
+	ExtentX.Reset();
+	ExtentZ.Reset();
+	Lifetime.Reset();
+	Released.Reset();
+}
+
+void AProjectileManager::Add(AProjectile* Projectile)
+{
+	const FVector Location = Projectile->GetActorLocation();
+	const FVector Velocity = Projectile->GetActorUpVector() * Projectile->InitialSpeed;
+	const FVector Extent = Projectile->GetRenderComponent()->Bounds.BoxExtent;
+
+	Projectile->ManagerIndex = Projectiles.Add(Projectile);
+	PositionX.Add(Location.X);
+	PositionY.Add(Location.Y);
+	PositionZ.Add(Location.Z);
+	VelocityX.Add(Velocity.X);
+	VelocityZ.Add(Velocity.Z);
+	ExtentX.Add(Extent.X);
+	ExtentZ.Add(Extent.Z);
+	Lifetime.Add(MaxFlightTime);
+}
+
+void AProjectileManager::Remove(AProjectile* Projectile)
+{
+	const int32 Index = Projectile->ManagerIndex;
+	if (!Projectiles.IsValidIndex(Index) || Projectiles[Index] != Projectile)
+	{
+		return;
+	}
+
+	Projectiles[Index] = nullptr;
+	Projectile->ManagerIndex = INDEX_NONE;
+	Released.Add(Index);
+
+	if (!bTicking)
+	{
+		RemoveReleased();
+	}
+}
+
+void AProjectileManager::RemoveReleased()
+{
+	// Highest first, so swapping in the last entry never moves a released one
+	Released.Sort(TGreater<int32>());
+
+	for (int32 Index : Released)
+	{
+		Projectiles.RemoveAtSwap(Index, 1, false);
+		PositionX.RemoveAtSwap(Index, 1, false);
+		PositionY.RemoveAtSwap(Index, 1, false);
+		PositionZ.RemoveAtSwap(Index, 1, false);
+		VelocityX.RemoveAtSwap(Index, 1, false);
+		VelocityZ.RemoveAtSwap(Index, 1, false);
+		ExtentX.RemoveAtSwap(Index, 1, false);
+		ExtentZ.RemoveAtSwap(Index, 1, false);
+		Lifetime.RemoveAtSwap(Index, 1, false);
+
+		if (Projectiles.IsValidIndex(Index) && Projectiles[Index])
+		{
+			Projectiles[Index]->ManagerIndex = Index;
+		}
+	}
+
+	Released.Reset();
+}
+
+bool AProjectileManager::SweepProjectile(int32 Index, const FVector& Target)
+{
+	AProjectile* Projectile = Projectiles[Index];
+
+	FHitResult Hit(1.f);
+	Projectile->SetActorLocation(Target, true, &Hit);
+
+	// Hitting the character releases the projectile
+	if (Projectiles[Index] != Projectile)
+	{
+		return false;
+	}
+
+	const FVector Location = Projectile->GetActorLocation();
+	PositionX[Index] = Location.X;
+	PositionZ[Index] = Location.Z;
+
+	if (Hit.bBlockingHit)
+	{
+		Projectile->Land();
+		VelocityX[Index] = 0.f;
+		VelocityZ[Index] = 0.f;
+		Lifetime[Index] = StuckTime;
+	}
+
+	return true;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ActorPool.h"
+#include "ProjectileManager.generated.h"
+
+class AProjectile;
+
+/**
+ * Moves every dart projectile in a single tick, keeping their state in flat arrays.
+ * Steps that the collision grid reports clear of tiles and far from the character only move the sprite,
+ * anything else falls back to a swept move of the projectile, which hits walls, hazards and the character as before.
+ */
+UCLASS()
+class RAGELITE_API AProjectileManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AProjectileManager();
+
+	/** Time a projectile stays stuck in a wall before going back to the pool. */
+	UPROPERTY(EditAnywhere, Category = Projectiles)
+	float StuckTime;
+
+	/** Projectiles still flying after this time go back to the pool. */
+	UPROPERTY(EditAnywhere, Category = Projectiles)
+	float MaxFlightTime;
+
+	TRlActorPool<AProjectile> Pool;
+
+	/** Takes a projectile from the pool and launches it along the up vector of Rotation. */
+	AProjectile* Fire(const FVector& Location, const FRotator& Rotation, float Speed);
+
+	void Release(AProjectile* Projectile);
+
+	void ReleaseAll();
+
+	int32 Num() const { return Projectiles.Num(); }
+
+	virtual void PostInitializeComponents() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// One entry per projectile, X and Z on the level plane
+
+	TArray<AProjectile*> Projectiles;
+
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+
+	/** Zero once stuck. */
+	TArray<float> VelocityX;
+	TArray<float> VelocityZ;
+
+	/** Half size of the sprite bounds. */
+	TArray<float> ExtentX;
+	TArray<float> ExtentZ;
+
+	/** Time left before going back to the pool. */
+	TArray<float> Lifetime;
+
+	/** Positions at the end of the current tick, kept to reuse the allocation. */
+	TArray<float> TargetX;
+	TArray<float> TargetZ;
+
+	/** Released projectiles are removed at the end of the tick, so a release during a move does not reorder the arrays. */
+	TArray<int32> Released;
+
+	bool bTicking;
+
+	void Add(AProjectile* Projectile);
+
+	void Remove(AProjectile* Projectile);
+
+	void RemoveReleased();
+
+	/** Moves the projectile with a sweep. Returns false if it was released by a hit. */
+	bool SweepProjectile(int32 Index, const FVector& Target);
+};
@@ -16,6 +16,15 @@ FHazardsData::FHazardsData()
 	bSpawnsFrom = true;
 }
 
+FRlLevelProgressionRow::FRlLevelProgressionRow()
+{
+	Level = 0;
+	UnlockedAbilities = 0;
+	TutorialTileMap = INDEX_NONE;
+	TutorialAnimation = ERlInputTutorial::None;
+	bEndCalibration = false;
+}
+
 int32 FHazardsData::Num() const
 {
 	int32 Count = 0;
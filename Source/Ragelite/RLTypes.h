@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "UObject/SoftObjectPtr.h"
+#include "Engine/DataTable.h"
 #include "RLTypes.generated.h"
 
 
@@ -94,8 +96,9 @@ struct FRlLevel
 {
 	GENERATED_BODY()
 
+	/** Soft, so only the current and the next level are loaded. */
 	UPROPERTY(EditAnywhere, Category = "Levels|Level")
-	UPaperTileMap* PaperTileMap;
+	TSoftObjectPtr<UPaperTileMap> PaperTileMap;
 
 	UPROPERTY(EditAnywhere, Category = "Levels|Level")
 	FVector2D Start;
@@ -105,4 +108,70 @@ struct FRlLevel
 
 	UPROPERTY(EditAnywhere, Category = "Levels|Level")
 	TArray<FHazardsData> Hazards;
+};
+
+UENUM(Meta = (Bitflags))
+enum class ERlAbility : int32
+{
+	Run,
+	Jump,
+	LongJump,
+	WallWalk
+};
+
+/** Animations of the input tutorial, named after the level they were made for. */
+UENUM()
+enum class ERlInputTutorial : uint8
+{
+	None,
+	LevelOne,
+	LevelTwo,
+	LevelThree,
+	LevelFour
+};
+
+/** Row of the level progression table, what happens when a level is entered. */
+USTRUCT()
+struct FRlLevelProgressionRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	FRlLevelProgressionRow();
+
+	UPROPERTY(EditAnywhere)
+	int32 Level;
+
+	/** Added to the abilities of the previous rows. Levels before the first row keep the abilities of the character. */
+	UPROPERTY(EditAnywhere, Meta = (Bitmask, BitmaskEnum = "ERlAbility"))
+	int32 UnlockedAbilities;
+
+	/** Index in the input tutorial tile maps, INDEX_NONE hides the tutorial. */
+	UPROPERTY(EditAnywhere)
+	int32 TutorialTileMap;
+
+	UPROPERTY(EditAnywhere)
+	ERlInputTutorial TutorialAnimation;
+
+	/** Ends the heart rate calibration if it is still running. */
+	UPROPERTY(EditAnywhere)
+	bool bEndCalibration;
+};
+
+/** Progression of a single level, compiled from the rows so entering a level is a lookup. */
+struct FRlLevelProgression
+{
+	bool bSetsAbilities;
+
+	/** ERlAbility bits of every ability enabled on the level. */
+	int32 Abilities;
+
+	int32 TutorialTileMap;
+
+	ERlInputTutorial TutorialAnimation;
+
+	bool bEndCalibration;
+
+	FRlLevelProgression() : bSetsAbilities(false), Abilities(0), TutorialTileMap(INDEX_NONE), TutorialAnimation(ERlInputTutorial::None), bEndCalibration(false) {};
+
+	bool HasAbility(ERlAbility Ability) const { return !!(Abilities & (1 << (int32)Ability)); }
 };
\ No newline at end of file
@@ -3,3 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/** Game systems, shown with "stat Ragelite". */
+DECLARE_STATS_GROUP(TEXT("Ragelite"), STATGROUP_Ragelite, STATCAT_Advanced);
@@ -3,6 +3,7 @@
 // This file has utf-8 enconding
 
 #include "RlCharacter.h"
+#include "Ragelite.h"
 #include "RlCharacterMovementComponent.h"
 #include "PaperFlipbookComponent.h"
 #include "PaperFlipbook.h"
@@ -28,11 +29,13 @@
 #include "RlGameMode.h"
 #include "HearRateModule.h"
 #include "WidgetManager.h"
+#include "BridgeManager.h"
+#include "SessionRecorder.h"
+#include "InputRecorder.h"
+#include "GhostRun.h"
+#include "LatencyTracer.h"
 
-#include "Runtime/Networking/Public/Common/TcpSocketBuilder.h"
-#include "Runtime/Networking/Public/Common/TcpListener.h"
-#include "Runtime/Networking/Public/Interfaces/IPv4/IPv4Endpoint.h"
-#include "Runtime/Networking/Public/Interfaces/IPv4/IPv4Address.h"
+#include "BridgeProtocol.h"
 
 #include <string>
 #include <sstream>
@@ -43,6 +46,10 @@ DEFINE_LOG_CATEGORY_STATIC(LogHeartRate, Log, All);
 DEFINE_LOG_CATEGORY_STATIC(LogDevice, Log, All);
 DEFINE_LOG_CATEGORY_STATIC(LogStatus, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("Character Tick"), STAT_RlCharacterTick, STATGROUP_Ragelite);
+DECLARE_CYCLE_STAT(TEXT("Character UpdateAnimation"), STAT_RlUpdateAnimation, STATGROUP_Ragelite);
+DECLARE_CYCLE_STAT(TEXT("Character CheckServer"), STAT_RlCheckServer, STATGROUP_Ragelite);
+
 FName ARlCharacter::SpriteComponentName(TEXT("Sprite0"));
 FName ARlCharacter::RlCharacterMovementComponentName(TEXT("RlCharMoveComp"));
 FName ARlCharacter::BoxComponentName(TEXT("CollisionBox"));
@@ -185,7 +192,11 @@ void ARlCharacter::PostInitializeComponents()
 
 	// Animation
 
-	auto IdleLambda = [](ARlCharacter* This) -> UPaperFlipbook* { return This->bIsLastDirectionRight ? This->IdleRightAnimation : This->IdleLeftAnimation; };
+	BuildIdleVariants(IdleRightAnimation, IdleRightAnimationExtras, IdleRightVariants);
+	BuildIdleVariants(IdleLeftAnimation, IdleLeftAnimationExtras, IdleLeftVariants);
+	IdleVariant = 0;
+
+	auto IdleLambda = [](ARlCharacter* This) -> UPaperFlipbook* { return This->GetIdleAnimation(); };
 	auto ToIdleLambda = [](ARlCharacter* This) -> UPaperFlipbook* { return This->bIsLastDirectionRight ? This->ToIdleRightAnimation : This->ToIdleLeftAnimation; };
 	auto RunningLambda = [](ARlCharacter* This) -> UPaperFlipbook*
 	{
@@ -218,63 +229,63 @@ void ARlCharacter::PostInitializeComponents()
 	auto JumpStart = [](ARlCharacter* This) -> bool { return This->bStoredJump; };
 	auto FallStart = [](ARlCharacter* This) -> bool { return This->RlCharacterMovement->Velocity.Z < 0.f; };
 
-	IA.Transitions.Add(FRlTransition(FallStart, ERlAnimationState::ToFalling));
-	IA.Transitions.Add(FRlTransition(JumpStart, ERlAnimationState::ToJumping));
-	IA.Transitions.Add(FRlTransition([](ARlCharacter* This) -> bool
+	IA.AddTransition(FallStart, ERlAnimationState::ToFalling);
+	IA.AddTransition(JumpStart, ERlAnimationState::ToJumping);
+	IA.AddTransition([](ARlCharacter* This) -> bool
 	{
 		return This->RlCharacterMovement->GetCurrentAcceleration().X != 0.f;
-	}, ERlAnimationState::ToIdleR));
+	}, ERlAnimationState::ToIdleR);
 
-	TIA.Transitions.Add(FRlTransition(FallStart, ERlAnimationState::ToFalling));
-	TIA.Transitions.Add(FRlTransition(JumpStart, ERlAnimationState::ToJumping));
-	TIA.Transitions.Add(FRlTransition(AnimationStopped, ERlAnimationState::Idle));
-	TIA.Transitions.Add(FRlTransition([](ARlCharacter* This) -> bool
+	TIA.AddTransition(FallStart, ERlAnimationState::ToFalling);
+	TIA.AddTransition(JumpStart, ERlAnimationState::ToJumping);
+	TIA.AddTransition(AnimationStopped, ERlAnimationState::Idle);
+	TIA.AddTransition([](ARlCharacter* This) -> bool
 	{
 		return FMath::Abs(This->RlCharacterMovement->Velocity.X) > This->WalkSpeed && This->RlCharacterMovement->GetCurrentAcceleration().X != 0.f;
-	}, ERlAnimationState::ToIdleR));
+	}, ERlAnimationState::ToIdleR);
 
-	TIRA.Transitions.Add(FRlTransition(FallStart, ERlAnimationState::ToFalling));
-	TIRA.Transitions.Add(FRlTransition(JumpStart, ERlAnimationState::ToJumping));
-	TIRA.Transitions.Add(FRlTransition(AnimationStopped, ERlAnimationState::Running));
-	TIRA.Transitions.Add(FRlTransition([](ARlCharacter* This) -> bool
+	TIRA.AddTransition(FallStart, ERlAnimationState::ToFalling);
+	TIRA.AddTransition(JumpStart, ERlAnimationState::ToJumping);
+	TIRA.AddTransition(AnimationStopped, ERlAnimationState::Running);
+	TIRA.AddTransition([](ARlCharacter* This) -> bool
 	{
 		return FMath::Abs(This->RlCharacterMovement->Velocity.X) < This->WalkSpeed && This->RlCharacterMovement->GetCurrentAcceleration().X == 0.f;
-	}, ERlAnimationState::ToIdle));
+	}, ERlAnimationState::ToIdle);
 
-	RA.Transitions.Add(FRlTransition(FallStart, ERlAnimationState::ToFalling));
-	RA.Transitions.Add(FRlTransition(JumpStart, ERlAnimationState::ToJumping));
-	RA.Transitions.Add(FRlTransition([](ARlCharacter* This) -> bool
+	RA.AddTransition(FallStart, ERlAnimationState::ToFalling);
+	RA.AddTransition(JumpStart, ERlAnimationState::ToJumping);
+	RA.AddTransition([](ARlCharacter* This) -> bool
 	{
 		return !This->RlCharacterMovement->IsWallWalking() && This->RlCharacterMovement->GetCurrentAcceleration().X == 0.f && !This->bIsChangingDirection && FMath::Abs(This->RlCharacterMovement->Velocity.X) < This->WalkSpeed;
-	}, ERlAnimationState::ToIdle));
+	}, ERlAnimationState::ToIdle);
 
 	// Jumping
-	TJA.Transitions.Add(FRlTransition(AnimationStopped, ERlAnimationState::Jumping));
+	TJA.AddTransition(AnimationStopped, ERlAnimationState::Jumping);
 
-	JA.Transitions.Add(FRlTransition([](ARlCharacter* This) -> bool
+	JA.AddTransition([](ARlCharacter* This) -> bool
 	{
 		return This->RlCharacterMovement->Velocity.Z <= 0.f;
-	}, ERlAnimationState::ToFalling));
+	}, ERlAnimationState::ToFalling);
 
-	TFA.Transitions.Add(FRlTransition(AnimationStopped, ERlAnimationState::Falling));
+	TFA.AddTransition(AnimationStopped, ERlAnimationState::Falling);
 
-	FA.Transitions.Add(FRlTransition([](ARlCharacter* This) -> bool
+	FA.AddTransition([](ARlCharacter* This) -> bool
 	{
 		return This->RlCharacterMovement->Velocity.Z == 0.f;
-	}, ERlAnimationState::Landing));
+	}, ERlAnimationState::Landing);
 
-	LA.Transitions.Add(FRlTransition(AnimationStopped, ERlAnimationState::Running));
+	LA.AddTransition(AnimationStopped, ERlAnimationState::Running);
 
-	AnimationLibrary.Add(ERlAnimationState::Idle, IA);
-	AnimationLibrary.Add(ERlAnimationState::ToIdle, TIA);
-	AnimationLibrary.Add(ERlAnimationState::ToIdleR, TIRA);
-	AnimationLibrary.Add(ERlAnimationState::Running, RA);
+	AnimationTable[(int32)ERlAnimationState::Idle] = IA;
+	AnimationTable[(int32)ERlAnimationState::ToIdle] = TIA;
+	AnimationTable[(int32)ERlAnimationState::ToIdleR] = TIRA;
+	AnimationTable[(int32)ERlAnimationState::Running] = RA;
 
-	AnimationLibrary.Add(ERlAnimationState::ToJumping, TJA);
-	AnimationLibrary.Add(ERlAnimationState::Jumping, JA);
-	AnimationLibrary.Add(ERlAnimationState::ToFalling, TFA);
-	AnimationLibrary.Add(ERlAnimationState::Falling, FA);
-	AnimationLibrary.Add(ERlAnimationState::Landing, LA);
+	AnimationTable[(int32)ERlAnimationState::ToJumping] = TJA;
+	AnimationTable[(int32)ERlAnimationState::Jumping] = JA;
+	AnimationTable[(int32)ERlAnimationState::ToFalling] = TFA;
+	AnimationTable[(int32)ERlAnimationState::Falling] = FA;
+	AnimationTable[(int32)ERlAnimationState::Landing] = LA;
 
 	SetCurrentState(ERlAnimationState::Idle);
 
@@ -306,15 +317,19 @@ void ARlCharacter::BeginPlay()
 
 	URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance());
 
+	if (RlGI->FixedTickRate > 0)
+	{
+		RlCharacterMovement->bUseFixedTimeStep = true;
+		RlCharacterMovement->FixedTimeStep = 1.f / RlGI->FixedTickRate;
+	}
+
+	RlCharacterMovement->bUseCollisionGrid = RlGI->bUseCollisionGrid;
+
 	if (RlGI->bUseDevice)
 	{
 		//UKismetSystemLibrary::PrintString(GetWorld(), FString("Start Server"));
 		UE_LOG(LogStatus, Log, TEXT("Start Server"));
-		FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1242);
-
-		TcpListener = new FTcpListener(IPv4Endpoint);
-
-		TcpListener->OnConnectionAccepted().BindUObject(this, &ARlCharacter::OnConnection);
+		RlGI->BridgeManager->StartReceiver();
 
 		// This will start the client of the band, so HRM must be running. Move to a separated method later.
 		AdvertisementWatcher(true);
@@ -350,17 +365,7 @@ void ARlCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 void ARlCharacter::CloseConnection()
 {
-	if (TcpListener)
-	{
-		TcpListener->Stop();
-		delete TcpListener;
-		TcpListener = nullptr;
-	}
-	if (ConnectionSocket)
-	{
-		ConnectionSocket->Close();
-		ConnectionSocket = nullptr;
-	}
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->StopReceiver();
 }
 
 UPawnMovementComponent* ARlCharacter::GetMovementComponent() const
@@ -385,6 +390,11 @@ float ARlCharacter::GetDefaultHalfHeight() const
 // meh
 void ARlCharacter::Jump(FKey Key)
 {
+	if (!ShouldProcessInput(ERlInputButton::Jump, true))
+	{
+		return;
+	}
+
 	//bIsUsingGamepad = Key.IsGamepadKey();
 
 	//Cast<URlGameInstance>(GetGameInstance())->LevelManager->UpdateInputTutorial();
@@ -411,9 +421,36 @@ void ARlCharacter::Jump(FKey Key)
 // meh
 void ARlCharacter::StopJumping()
 {
+	if (!ShouldProcessInput(ERlInputButton::Jump, false))
+	{
+		return;
+	}
+
 	ResetJumpState();
 }
 
+void ARlCharacter::Sprint()
+{
+	if (ShouldProcessInput(ERlInputButton::Sprint, true))
+	{
+		RlCharacterMovement->SprintStart();
+	}
+}
+
+void ARlCharacter::StopSprinting()
+{
+	if (ShouldProcessInput(ERlInputButton::Sprint, false))
+	{
+		RlCharacterMovement->SprintStop();
+	}
+}
+
+bool ARlCharacter::ShouldProcessInput(ERlInputButton Button, bool bPressed)
+{
+	FRlInputRecorder* InputRecorder = Cast<URlGameInstance>(GetGameInstance())->InputRecorder;
+	return !InputRecorder || InputRecorder->OnButton(Button, bPressed);
+}
+
 // meh
 void ARlCharacter::ResetJumpState()
 {
@@ -976,6 +1013,8 @@ float ARlCharacter::GetJumpMaxHoldTime() const
 // meh
 void ARlCharacter::Tick(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RlCharacterTick);
+
 	Super::Tick(DeltaTime);
 
 	CurrentDeltaTime = DeltaTime;
@@ -984,6 +1023,11 @@ void ARlCharacter::Tick(float DeltaTime)
 
 	URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance());
 
+	if (RlGI->GhostRecorder)
+	{
+		RlGI->GhostRecorder->Record(this, DeltaTime);
+	}
+
 	if (RlGI->bUseDevice)
 	{
 		CheckServer();
@@ -1018,6 +1062,8 @@ void ARlCharacter::MoveRight(float Value)
 // meh
 void ARlCharacter::UpdateAnimation()
 {
+	SCOPE_CYCLE_COUNTER(STAT_RlUpdateAnimation);
+
 	// Dust update
 
 	float VX = RlCharacterMovement->Velocity.X;
@@ -1037,7 +1083,7 @@ void ARlCharacter::UpdateAnimation()
 		DustComponent->Activate(true);
 	}
 
-	FRlAnimation CurrentAnimationInfo = AnimationLibrary[CurrentState];
+	const FRlAnimation& CurrentAnimationInfo = GetAnimation(CurrentState);
 
 	// Check Start and End
 	if (CurrentAnimationInfo.bReverse)
@@ -1104,51 +1150,116 @@ void ARlCharacter::UpdateAnimation()
 		//bIsChangingDirection = false;
 	}
 
-	if (AnimationLibrary.Contains(CurrentState))
+	const FRlAnimation& StateAnimation = GetAnimation(CurrentState);
+	for (int32 i = 0; i < StateAnimation.NumTransitions; ++i)
 	{
-		for (FRlTransition Transition : AnimationLibrary[CurrentState].Transitions)
+		const FRlTransition& Transition = StateAnimation.Transitions[i];
+		if (Transition.Predicate(this))
 		{
-			if (Transition.Predicate(this))
-			{
-				SetCurrentState(Transition.NextState);
-				break;
-			}
+			SetCurrentState(Transition.NextState);
+			break;
 		}
 	}
 
 	// Change start of TJA to match state of TIRA
 
+	// Running speeds the animation up with the velocity, on the component so the flipbook asset keeps its frame rate
+	float PlayRate = 1.f;
 	if (CurrentState == ERlAnimationState::Running)
 	{
-		FScopedFlipbookMutator ScopedFlipbookMutator(Sprite->GetFlipbook());
-		ScopedFlipbookMutator.FramesPerSecond = FMath::Max(FMath::RoundToInt((WalkSpeed * FMath::Abs(RlCharacterMovement->Velocity.X)) / RlCharacterMovement->NormalMaxWalkSpeed), 10);
+		const UPaperFlipbook* CurrentAnimation = Sprite->GetFlipbook();
+		const float FramesPerSecond = FMath::Max(FMath::RoundToInt((WalkSpeed * FMath::Abs(RlCharacterMovement->Velocity.X)) / RlCharacterMovement->NormalMaxWalkSpeed), 10);
+		if (CurrentAnimation && CurrentAnimation->GetFramesPerSecond() > 0.f)
+		{
+			PlayRate = FramesPerSecond / CurrentAnimation->GetFramesPerSecond();
+		}
+	}
+	if (Sprite->GetPlayRate() != PlayRate)
+	{
+		Sprite->SetPlayRate(PlayRate);
 	}
 
-	if (CurrentState == ERlAnimationState::Idle)
+	if (CurrentState == ERlAnimationState::Idle && IdleRightVariants.Num() && IdleRightVariants.Num() == IdleLeftVariants.Num())
 	{
-		UPaperFlipbook* CurrentAnimation = AnimationLibrary[CurrentState].Animation(this);
-		UPaperFlipbook* CurrentAnimationExtras = bIsLastDirectionRight ? IdleRightAnimationExtras : IdleLeftAnimationExtras;
-
 		const float EffectiveDeltaTime = CurrentDeltaTime * Sprite->GetPlayRate();
 		float NewPosition = Sprite->GetPlaybackPosition() + EffectiveDeltaTime;
 
-		if (CurrentAnimation  && CurrentAnimationExtras && NewPosition > Sprite->GetFlipbookLength())
+		// New extras on every loop
+		if (NewPosition > Sprite->GetFlipbookLength())
 		{
-			FScopedFlipbookMutator ScopedFlipbookMutator(CurrentAnimation);
-			ScopedFlipbookMutator.KeyFrames[1] = CurrentAnimationExtras->GetKeyFrameChecked(FMath::RandRange(0, 1));
-			ScopedFlipbookMutator.KeyFrames[3] = CurrentAnimationExtras->GetKeyFrameChecked(FMath::RandRange(2, 4));
+			IdleVariant = FMath::RandRange(0, IdleRightVariants.Num() - 1);
+			Sprite->SetFlipbook(GetIdleAnimation());
 		}
 	}
 }
 
+// meh
+void ARlCharacter::BuildIdleVariants(UPaperFlipbook* IdleAnimation, UPaperFlipbook* IdleAnimationExtras, TArray<UPaperFlipbook*>& OutVariants)
+{
+	OutVariants.Reset();
+
+	if (!IdleAnimation || !IdleAnimationExtras || IdleAnimation->GetNumKeyFrames() < 4 || IdleAnimationExtras->GetNumKeyFrames() < 5)
+	{
+		return;
+	}
+
+	// Frame 1 takes one of extras 0 and 1, frame 3 one of extras 2 to 4
+	for (int32 First = 0; First <= 1; ++First)
+	{
+		for (int32 Second = 2; Second <= 4; ++Second)
+		{
+			UPaperFlipbook* Variant = DuplicateObject<UPaperFlipbook>(IdleAnimation, this);
+			Variant->SetFlags(RF_Transient);
+
+			FScopedFlipbookMutator ScopedFlipbookMutator(Variant);
+			ScopedFlipbookMutator.KeyFrames[1] = IdleAnimationExtras->GetKeyFrameChecked(First);
+			ScopedFlipbookMutator.KeyFrames[3] = IdleAnimationExtras->GetKeyFrameChecked(Second);
+
+			OutVariants.Add(Variant);
+		}
+	}
+}
+
+UPaperFlipbook* ARlCharacter::GetStateFlipbook(ERlAnimationState State, bool bRight, bool bWallWalking) const
+{
+	switch (State)
+	{
+	case ERlAnimationState::Idle:
+		return bRight ? IdleRightAnimation : IdleLeftAnimation;
+	case ERlAnimationState::ToIdle:
+	case ERlAnimationState::ToIdleR:
+		return bRight ? ToIdleRightAnimation : ToIdleLeftAnimation;
+	case ERlAnimationState::Running:
+		if (bWallWalking)
+		{
+			return bRight ? WallWalkRightAnimation : WallWalkLeftAnimation;
+		}
+		return bRight ? RunningRightAnimation : RunningLeftAnimation;
+	default:
+		return bRight ? JumpRightAnimation : JumpLeftAnimation;
+	}
+}
+
+UPaperFlipbook* ARlCharacter::GetIdleAnimation() const
+{
+	const TArray<UPaperFlipbook*>& Variants = bIsLastDirectionRight ? IdleRightVariants : IdleLeftVariants;
+	if (Variants.IsValidIndex(IdleVariant))
+	{
+		return Variants[IdleVariant];
+	}
+	return bIsLastDirectionRight ? IdleRightAnimation : IdleLeftAnimation;
+}
+
 // meh
 void ARlCharacter::SetCurrentState(ERlAnimationState State)
 {
 	ERlAnimationState OldState = CurrentState;
 	CurrentState = State;
 
-	UPaperFlipbook* OldAnimation = AnimationLibrary[OldState].Animation(this);
-	UPaperFlipbook* CurrentAnimation = AnimationLibrary[CurrentState].Animation(this);
+	const FRlAnimation& StateAnimation = GetAnimation(CurrentState);
+
+	UPaperFlipbook* OldAnimation = GetAnimation(OldState).Animation(this);
+	UPaperFlipbook* CurrentAnimation = StateAnimation.Animation(this);
 	float OldFrame = Sprite->GetPlaybackPositionInFrames();
 
 	bool bChangedAnimation = OldAnimation != CurrentAnimation;
@@ -1164,7 +1275,7 @@ void ARlCharacter::SetCurrentState(ERlAnimationState State)
 
 	Sprite->SetFlipbook(CurrentAnimation);
 
-	Sprite->SetLooping(AnimationLibrary[CurrentState].bLoop);
+	Sprite->SetLooping(StateAnimation.bLoop);
 
 	if (OldState == ERlAnimationState::Idle && CurrentState == ERlAnimationState::ToJumping)
 	{
@@ -1178,20 +1289,20 @@ void ARlCharacter::SetCurrentState(ERlAnimationState State)
 		Sprite->SetPlaybackPositionInFrames(OldFrame, false);
 	}
 
-	if (AnimationLibrary[CurrentState].bReverse)
+	if (StateAnimation.bReverse)
 	{
-		if (!AnimationLibrary[CurrentState].bKeepFrame || bChangedAnimation)
+		if (!StateAnimation.bKeepFrame || bChangedAnimation)
 		{
-			const int End = AnimationLibrary[CurrentState].End;
+			const int End = StateAnimation.End;
 			Sprite->SetPlaybackPositionInFrames(End != -1 ? End : Sprite->GetFlipbookLengthInFrames(), false);
 		}
 		Sprite->Reverse();
 	}
 	else
 	{
-		if (!AnimationLibrary[CurrentState].bKeepFrame || bChangedAnimation)
+		if (!StateAnimation.bKeepFrame || bChangedAnimation)
 		{
-			const int Start = AnimationLibrary[CurrentState].Start;
+			const int Start = StateAnimation.Start;
 			Sprite->SetPlaybackPositionInFrames(Start != -1 ? Start : 0.f, false);
 		}
 		Sprite->Play();
@@ -1303,6 +1414,11 @@ void ARlCharacter::Death()
 	{
 		Vibrate(100);
 
+		if (FRlSessionRecorder* SessionRecorder = Cast<URlGameInstance>(GetGameInstance())->SessionRecorder)
+		{
+			SessionRecorder->Record(ERlSessionEvent::Death);
+		}
+
 		bDeath = true;
 		Sprite->ToggleVisibility();
 
@@ -1344,6 +1460,11 @@ void ARlCharacter::Up()
 
 	//HearRate(true);
 
+	if (!ShouldProcessInput(ERlInputButton::Up, true))
+	{
+		return;
+	}
+
 	if (!bDeath)
 	{
 		TArray<AActor*> Stairs;
@@ -1364,94 +1485,31 @@ void ARlCharacter::Up()
 // meh
 void ARlCharacter::Vibrate(uint16 Milliseconds)
 {
-	int32 Sent;
-	const uint8 Id = 0x04;
-	//const uint8 Data[] = { 0x00, (Milliseconds >> 8) & 0xff, Milliseconds & 0xff };
-
-	FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1243);
-
-	FSocket* Socket = FTcpSocketBuilder(TEXT("FTcpListener server"));
-	Socket->Connect(*IPv4Endpoint.ToInternetAddr());
-	Socket->Send(&Id, 1, Sent);
-	Socket->Send((const uint8*)&Milliseconds, 2, Sent);
-	Socket->Close();
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->Vibrate(Milliseconds);
 }
 
 // meh
 void ARlCharacter::WriteMessage(uint8* Message, uint32 MessageSize)
 {
-	//Message.
-	int32 Sent;
-	const uint8 Id = 0x02;
-
-	FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1243);
-
-	FSocket* Socket = FTcpSocketBuilder(TEXT("FTcpListener server"));
-	Socket->Connect(*IPv4Endpoint.ToInternetAddr());
-	Socket->Send(&Id, 1, Sent);
-	Socket->Send((const uint8*)&MessageSize, 4, Sent);
-	Socket->Send(Message, MessageSize, Sent);
-
-	Socket->Close();
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->WriteMessage(Message, MessageSize);
 }
 
 // meh
 void ARlCharacter::HearRate(bool bStart)
 {
-	int32 Sent;
-	const uint8 Id = 0x03;
-
-	FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1243);
-
-	FSocket* Socket = FTcpSocketBuilder(TEXT("FTcpListener server"));
-	Socket->Connect(*IPv4Endpoint.ToInternetAddr());
-	Socket->Send(&Id, 1, Sent);
-	Socket->Send((const uint8*)&bStart, 1, Sent);
-
-	Socket->Close();
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->HeartRate(bStart);
 }
 
 // meh
 void ARlCharacter::AdvertisementWatcher(bool bStart)
 {
-	int32 Sent;
-	const uint8 Id = 0x00;
-
-	FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1243);
-
-	FSocket* Socket = FTcpSocketBuilder(TEXT("FTcpListener server"));
-	Socket->Connect(*IPv4Endpoint.ToInternetAddr());
-	Socket->Send(&Id, 1, Sent);
-	Socket->Send((const uint8*)&bStart, 1, Sent);
-
-	Socket->Close();
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->AdvertisementWatcher(bStart);
 }
 
 // meh
 void ARlCharacter::Connect(FString Device)
 {
-	int32 Sent;
-	const uint8 Id = 0x01;
-
-	////auto a = Device.GetCharArray();
-
-	//auto a = *Device;
-
-	uint32 MessageSize = Device.Len();
-
-	char* Message = TCHAR_TO_ANSI(*Device);
-
-	auto a = Device;
-
-	FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1243);
-
-	FSocket* Socket = FTcpSocketBuilder(TEXT("FTcpListener server"));
-	Socket->Connect(*IPv4Endpoint.ToInternetAddr());
-	Socket->Send(&Id, 1, Sent);
-	Socket->Send((const uint8*)&MessageSize, 4, Sent);
-	Socket->Send((const uint8*)Message, MessageSize, Sent);
-
-	Socket->Close();
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->Connect(Device);
 
 	UWidgetManager* WM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->WidgetManager;
 	if (WM->DeviceSelection)
@@ -1463,120 +1521,74 @@ void ARlCharacter::Connect(FString Device)
 // meh
 void ARlCharacter::Vibrate()
 {
-	int32 Sent;
-	const uint8 Id = 0x05;
-
-	FIPv4Endpoint IPv4Endpoint(FIPv4Address(127, 0, 0, 1), 1243);
-
-	FSocket* Socket = FTcpSocketBuilder(TEXT("FTcpListener server"));
-	Socket->Connect(*IPv4Endpoint.ToInternetAddr());
-	Socket->Send(&Id, 1, Sent);
-	Socket->Close();
-}
-
-// meh	
-bool ARlCharacter::OnConnection(FSocket* Socket, const struct FIPv4Endpoint& IPv4Endpoint)
-{
-	bConnectionAccepted = true;
-	//UKismetSystemLibrary::PrintString(GetWorld(), FString("Connection accepted"));
-	UE_LOG(LogStatus, Log, TEXT("Connection accepted"));
-	ConnectionSocket = Socket;
-	int32 NewSize;
-	if (!bDeviceConnected)
-	{
-		ConnectionSocket->SetReceiveBufferSize(17 * sizeof(uint8), NewSize);
-	}
-	else
-	{
-		ConnectionSocket->SetReceiveBufferSize(2 * sizeof(uint8), NewSize);
-	}
-	return true;
+	Cast<URlGameInstance>(GetGameInstance())->BridgeManager->Vibrate();
 }
 
 // meh	
 void ARlCharacter::CheckServer()
 {
-	if (!ConnectionSocket)
-	{
-		return;
-	}
+	SCOPE_CYCLE_COUNTER(STAT_RlCheckServer);
 
-	TArray<uint8> ReceivedData;
+	URlGameInstance* RlGI = Cast<URlGameInstance>(GetWorld()->GetGameInstance());
+	ULevelManager* LM = RlGI->LevelManager;
+	UWidgetManager* WM = RlGI->WidgetManager;
 
-	uint32 Size;
-	while (ConnectionSocket->HasPendingData(Size))
+	FRlBridgeMessage Message;
+	while (RlGI->BridgeManager->ReceiveMessage(Message))
 	{
-		ReceivedData.Init(0, FMath::Min(Size, 65507u));
+		bConnectionAccepted = true;
 
-		int32 Read = 0;
-		ConnectionSocket->Recv(ReceivedData.GetData(), ReceivedData.Num(), Read);
-	}
-
-	if (ReceivedData.Num() <= 0)
-	{
-		return;
-	}
-
-	ReceivedData.Add(0);
-	const FString ReceivedUE4String = FString(ANSI_TO_TCHAR(reinterpret_cast<const char*>(ReceivedData.GetData())));
-
-	ULevelManager* LM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->LevelManager;
-	UWidgetManager* WM = Cast<URlGameInstance>(GetWorld()->GetGameInstance())->WidgetManager;
-
-	if (!bDeviceConnected)
-	{
-		if (!ReceivedUE4String.Compare("Connected"))
+		if (!bDeviceConnected)
 		{
-			GetWorld()->GetTimerManager().ClearTimer(DeviceConnectionHandle);
+			if (Message.Type == ERlBridgeMessage::Connected)
+			{
+				GetWorld()->GetTimerManager().ClearTimer(DeviceConnectionHandle);
 
-			bDeviceConnected = true;
+				bDeviceConnected = true;
 
-			if (WM->DeviceSelection)
-			{
-				WM->DeviceSelection->RemoveFromParent();
-			}
+				if (WM->DeviceSelection)
+				{
+					WM->DeviceSelection->RemoveFromParent();
+				}
 
-			UE_LOG(LogStatus, Log, TEXT("Hear Rate Measurement Started"));
+				UE_LOG(LogStatus, Log, TEXT("Hear Rate Measurement Started"));
 
-			HearRate(true);
+				HearRate(true);
 
-			if (ARlGameMode* GameMode = Cast<ARlGameMode>(GetWorld()->GetAuthGameMode()))
-			{
-				GameMode->HeartRateModule->StartCalibration();
-			}
+				if (ARlGameMode* GameMode = Cast<ARlGameMode>(GetWorld()->GetAuthGameMode()))
+				{
+					GameMode->HeartRateModule->StartCalibration();
+				}
 
-			if (Cast<URlGameInstance>(GetWorld()->GetGameInstance())->bIntro)
-			{
-				WM->StartIntro();
+				if (RlGI->bIntro)
+				{
+					WM->StartIntro();
+				}
+				else
+				{
+					LM->SetLevel(ELevelState::Start);
+				}
 			}
-			else
+			else if (Message.Type == ERlBridgeMessage::DeviceAdvert && WM->DeviceSelection)
 			{
-				LM->SetLevel(ELevelState::Start);
+				// Formatted only when logged, adverts come many times per second
+				UE_LOG(LogDevice, Verbose, TEXT("%s"), *RlBridge::AddressToString(Message.Address));
+				WM->DeviceSelection->AddDevice(Message.Address);
 			}
-
-			//auto PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-			//PC->SetInputMode(FInputModeGameOnly());
-			//EnableInput(PC);
 		}
-		else if (WM->DeviceSelection)
-		{
-			UE_LOG(LogDevice, Log, TEXT("%s"), *ReceivedUE4String);
-			WM->DeviceSelection->AddDevice(ReceivedUE4String);
-		}
-	}
-	else
-	{
-		if (ReceivedUE4String.Len() == 2)
+		else if (Message.Type == ERlBridgeMessage::HeartRate)
 		{
+			if (RlGI->LatencyTracer)
+			{
+				RlGI->LatencyTracer->OnReceived(Message);
+			}
+
 			if (ARlGameMode* GameMode = Cast<ARlGameMode>(GetWorld()->GetAuthGameMode()))
 			{
-				GameMode->HeartRateModule->AddHeartRate(ReceivedUE4String);
+				GameMode->HeartRateModule->AddHeartRate(Message.HeartRate);
 			}
 		}
-		//UE_LOG(LogHeartRate, Log, TEXT("%s"), *ReceivedUE4String);
 	}
-
-	//UKismetSystemLibrary::PrintString(GetWorld(), FString::Printf(TEXT("Heart Rate: %s"), *ReceivedUE4String), true, true, FLinearColor(0.0, 0.66, 1.0), 20.f);
 }
 
 // meh
@@ -1603,9 +1615,9 @@ void ARlCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 
 	PlayerInputComponent->BindAction("Vibrate", IE_Pressed, this, &ARlCharacter::Vibrate);
 
-	PlayerInputComponent->BindAction("Sprint", IE_Pressed, RlCharacterMovement, &URlCharacterMovementComponent::SprintStart);
+	PlayerInputComponent->BindAction("Sprint", IE_Pressed, this, &ARlCharacter::Sprint);
 
-	PlayerInputComponent->BindAction("Sprint", IE_Released, RlCharacterMovement, &URlCharacterMovementComponent::SprintStop);
+	PlayerInputComponent->BindAction("Sprint", IE_Released, this, &ARlCharacter::StopSprinting);
 }
 
 #if WITH_EDITOR
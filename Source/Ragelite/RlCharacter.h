@@ -6,6 +6,7 @@
 #include "GameFramework/Pawn.h"
 #include "RlCharacterMovementComponent.h"
 #include "TimerManager.h"
+#include "InputRecorder.h"
 #include "RlCharacter.generated.h"
 
 class UPaperFlipbookComponent;
@@ -16,7 +17,6 @@ class FDebugDisplayInfo;
 class UPaperFlipbook;
 class UParticleSystem;
 class UParticleSystemComponent;
-class FSocket;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRlCharacterReachedApexSignature);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRlLandedSignature, const FHitResult&, Hit);
@@ -36,7 +36,8 @@ enum class ERlAnimationState : int8
 	Jumping,
 	ToFalling,
 	Falling,
-	Landing
+	Landing,
+	Num
 };
 
 struct FRlTransition
@@ -46,7 +47,7 @@ struct FRlTransition
 
 	ERlAnimationState NextState;
 
-	FRlTransition() {};
+	FRlTransition() : Predicate(nullptr), NextState(ERlAnimationState::Idle) {};
 
 	FRlTransition(bool(*InPredicate)(ARlCharacter*), ERlAnimationState InNextState)
 	{
@@ -68,9 +69,13 @@ struct FRlAnimation
 	int End; // -1 to play from end
 	bool bKeepFrame; // True to play from current frame
 
-	TArray<FRlTransition> Transitions; // First transitions have priority
+	static const int32 MaxTransitions = 4;
 
-	FRlAnimation() {};
+	// Inline, so evaluating a state touches a single entry of the animation table
+	FRlTransition Transitions[MaxTransitions]; // First transitions have priority
+	int32 NumTransitions;
+
+	FRlAnimation() : Animation(nullptr), bLoop(false), bReverse(false), Start(-1), End(-1), bKeepFrame(false), NumTransitions(0) {};
 
 	FRlAnimation(UPaperFlipbook* (*InAnimation)(ARlCharacter*), bool bInLoop, bool bInReverse, bool bInKeepFrame = false, int InStart = -1, int InEnd = -1)
 	{
@@ -80,7 +85,13 @@ struct FRlAnimation
 		Start = InStart;
 		End = InEnd;
 		bKeepFrame = bInKeepFrame;
-		
+		NumTransitions = 0;
+	}
+
+	void AddTransition(bool(*Predicate)(ARlCharacter*), ERlAnimationState NextState)
+	{
+		check(NumTransitions < MaxTransitions);
+		Transitions[NumTransitions++] = FRlTransition(Predicate, NextState);
 	}
 };
 
@@ -176,6 +187,13 @@ UCLASS(config=Game, BlueprintType, meta=(ShortTooltip="A character is a type of
 class RAGELITE_API ARlCharacter : public APawn
 {
 	GENERATED_BODY()
+
+	/** Replays call the input handlers. */
+	friend class FRlInputRecorder;
+
+	/** Drives the input handlers without a player controller. */
+	friend class UMovementBenchmarkCommandlet;
+
 public:
 	/** Default UObject constructor. */
 	ARlCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
@@ -335,8 +353,27 @@ private:
 
 	void SetCurrentState(ERlAnimationState State);
 
-	//UPROPERTY()
-	TMap<ERlAnimationState, FRlAnimation> AnimationLibrary;
+	/** Indexed by ERlAnimationState, filled once in PostInitializeComponents. */
+	FRlAnimation AnimationTable[(int32)ERlAnimationState::Num];
+
+	const FRlAnimation& GetAnimation(ERlAnimationState State) const { return AnimationTable[(int32)State]; }
+
+	/**
+	 * Copies of the idle animations owned by the character, one per combination of extras frames.
+	 * Picking extras switches copies, so the idle assets are never edited at runtime.
+	 */
+	UPROPERTY(Transient)
+	TArray<UPaperFlipbook*> IdleRightVariants;
+
+	UPROPERTY(Transient)
+	TArray<UPaperFlipbook*> IdleLeftVariants;
+
+	int32 IdleVariant;
+
+	void BuildIdleVariants(UPaperFlipbook* IdleAnimation, UPaperFlipbook* IdleAnimationExtras, TArray<UPaperFlipbook*>& OutVariants);
+
+	/** Current idle variant of the last direction, the idle asset itself if it has no extras. */
+	UPaperFlipbook* GetIdleAnimation() const;
 
 	int GetFlipbookLengthInFrames(UPaperFlipbook* (*Animation)(ARlCharacter*));
 
@@ -354,6 +391,11 @@ public:
 
 	bool bDust;
 
+	ERlAnimationState GetAnimationState() const { return CurrentState; }
+
+	/** Flipbook shown in an animation state, used by ghosts to draw recorded states. Idle is the asset without extras. */
+	UPaperFlipbook* GetStateFlipbook(ERlAnimationState State, bool bRight, bool bWallWalking) const;
+
 
 	// Animation
 	bool bIsLastDirectionRight;
@@ -382,11 +424,6 @@ public:
 
 	bool bDeviceConnected;
 
-	class FTcpListener* TcpListener;
-	FSocket* ConnectionSocket;
-
-	bool OnConnection(FSocket* Socket, const struct FIPv4Endpoint& IPv4Endpoint);
-
 	bool bConnectionAccepted;
 
 	void CheckServer();
@@ -584,6 +621,13 @@ public:
 	 */
 	virtual void StopJumping();
 
+	void Sprint();
+
+	void StopSprinting();
+
+	/** Returns false for player input that must be ignored, and feeds the input recorder. */
+	bool ShouldProcessInput(ERlInputButton Button, bool bPressed);
+
 	/**
 	 * Check if the character can jump in the current state.
 	 *
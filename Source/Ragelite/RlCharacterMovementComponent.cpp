@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "RlCharacterMovementComponent.h"
+#include "Ragelite.h"
 #include "RlCharacter.h"
 #include "GameFramework/PhysicsVolume.h"
 #include "Components/PrimitiveComponent.h"
@@ -9,13 +10,23 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "Spike.h"
+#include "PaperFlipbookComponent.h"
+#include "RlGameInstance.h"
+#include "InputRecorder.h"
+#include "MovementProfiler.h"
+#include "CollisionGrid.h"
+#include "LevelManager.h"
+#include "Paper2D/Classes/PaperTileMapComponent.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogCharacterMovement, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("Movement Tick"), STAT_RlMovementTick, STATGROUP_Ragelite);
+
 // MAGIC NUMBERS
 const float MAX_STEP_SIDE_Z = 0.08f;	// maximum z value for the normal on the vertical side of steps
 const float SWIMBOBSPEED = -80.f;
 const float VERTICAL_SLOPE_NORMAL_Z = 0.001f; // Slope is vertical if Abs(Normal.Z) <= this threshold. Accounts for precision problems that sometimes angle normals slightly off horizontal for vertical surface.
+const float GRID_MOVE_MARGIN = 0.1f;	// distance to the closest tile for a move to skip the sweep
 
 const float URlCharacterMovementComponent::MIN_TICK_TIME = 1e-6f;
 const float URlCharacterMovementComponent::MIN_FLOOR_DIST = 2.f;
@@ -97,6 +108,14 @@ URlCharacterMovementComponent::URlCharacterMovementComponent(const FObjectInitia
 	MaxSimulationTimeStep = 0.05f;
 	MaxSimulationIterations = 8;
 
+	bUseFixedTimeStep = false;
+	FixedTimeStep = 1.f / 120.f;
+	MaxFixedStepsPerFrame = 8;
+	FixedStepCount = 0;
+	FixedTimeAccumulator = 0.f;
+	PreviousFixedLocation = FVector::ZeroVector;
+	CurrentFixedLocation = FVector::ZeroVector;
+
 	//MaxDepenetrationWithGeometry = 500.f;
 	//MaxDepenetrationWithPawn = 100.f;
 
@@ -120,6 +139,7 @@ URlCharacterMovementComponent::URlCharacterMovementComponent(const FObjectInitia
 	bImpartBaseVelocityZ = true;
 	bImpartBaseAngularVelocity = true;
 	bAlwaysCheckFloor = true;
+	bUseCollisionGrid = true;
 
 	OldBaseQuat = FQuat::Identity;
 	OldBaseLocation = FVector::ZeroVector;
@@ -128,6 +148,8 @@ URlCharacterMovementComponent::URlCharacterMovementComponent(const FObjectInitia
 // meh
 void URlCharacterMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RlMovementTick);
+
 	const FVector InputVector = ConsumeInputVector();
 	if (!HasValidData() || ShouldSkipUpdate(DeltaTime))
 	{
@@ -150,19 +172,101 @@ void URlCharacterMovementComponent::TickComponent(float DeltaTime, enum ELevelTi
 
 	if (CharacterOwner->IsLocallyControlled() || (!CharacterOwner->Controller && bRunPhysicsWithNoController))
 	{
-		// We need to check the jump state before adjusting input acceleration, to minimize latency
-		// and to make sure acceleration respects our potentially new falling state.
-		CharacterOwner->CheckJumpInput(DeltaTime);
+		if (bUseFixedTimeStep)
+		{
+			TickFixedTimeStep(DeltaTime, InputVector);
+		}
+		else
+		{
+			SimulateStep(DeltaTime, InputVector);
+		}
+	}
 
-		// apply input to acceleration
-		Acceleration = ScaleInputAcceleration(ConstrainInputAcceleration(InputVector));
+	//UE_LOG(LogTemp, Warning, TEXT("Velocity: %f"), Velocity.Size());
+}
 
-		AnalogInputModifier = ComputeAnalogInputModifier();
+void URlCharacterMovementComponent::SimulateStep(float DeltaTime, const FVector& InputVector)
+{
+	// We need to check the jump state before adjusting input acceleration, to minimize latency
+	// and to make sure acceleration respects our potentially new falling state.
+	CharacterOwner->CheckJumpInput(DeltaTime);
 
-		PerformMovement(DeltaTime);
+	// apply input to acceleration
+	Acceleration = ScaleInputAcceleration(ConstrainInputAcceleration(InputVector));
+
+	AnalogInputModifier = ComputeAnalogInputModifier();
+
+	PerformMovement(DeltaTime);
+}
+
+void URlCharacterMovementComponent::TickFixedTimeStep(float DeltaTime, const FVector& InputVector)
+{
+	// Moved outside of the simulation (teleported to the start of a level), nothing to interpolate from
+	if (UpdatedComponent->GetComponentLocation() != CurrentFixedLocation)
+	{
+		CurrentFixedLocation = PreviousFixedLocation = UpdatedComponent->GetComponentLocation();
 	}
 
-	//UE_LOG(LogTemp, Warning, TEXT("Velocity: %f"), Velocity.Size());
+	FixedTimeAccumulator += DeltaTime;
+
+	FRlInputRecorder* InputRecorder = Cast<URlGameInstance>(CharacterOwner->GetGameInstance())->InputRecorder;
+
+	int32 Steps = 0;
+	while (FixedTimeAccumulator >= FixedTimeStep && Steps < MaxFixedStepsPerFrame)
+	{
+		FixedTimeAccumulator -= FixedTimeStep;
+		Steps++;
+
+		PreviousFixedLocation = CurrentFixedLocation;
+
+		FVector StepInputVector = InputVector;
+		if (InputRecorder)
+		{
+			InputRecorder->ProcessStep(CharacterOwner, StepInputVector);
+		}
+
+		SimulateStep(FixedTimeStep, StepInputVector);
+		FixedStepCount++;
+
+		if (!HasValidData())
+		{
+			return;
+		}
+
+		CurrentFixedLocation = UpdatedComponent->GetComponentLocation();
+
+		if (CharacterOwner->bDeath)
+		{
+			PreviousFixedLocation = CurrentFixedLocation;
+			FixedTimeAccumulator = 0.f;
+			break;
+		}
+	}
+
+	if (Steps == MaxFixedStepsPerFrame)
+	{
+		FixedTimeAccumulator = FMath::Min(FixedTimeAccumulator, FixedTimeStep);
+	}
+
+	UpdateRenderInterpolation();
+}
+
+void URlCharacterMovementComponent::UpdateRenderInterpolation()
+{
+	UPaperFlipbookComponent* Sprite = CharacterOwner->GetSprite();
+	if (!Sprite)
+	{
+		return;
+	}
+
+	const FVector DefaultSpriteLocation = CharacterOwner->GetClass()->GetDefaultObject<ARlCharacter>()->GetSprite()->RelativeLocation;
+
+	// The sprite lags one step behind the simulation, so it never shows a location that was not simulated
+	const float Alpha = FMath::Clamp(FixedTimeAccumulator / FixedTimeStep, 0.f, 1.f);
+	const FVector RenderLocation = FMath::Lerp(PreviousFixedLocation, CurrentFixedLocation, Alpha);
+	const FVector Offset = UpdatedComponent->GetComponentTransform().InverseTransformVectorNoScale(RenderLocation - CurrentFixedLocation);
+
+	Sprite->SetRelativeLocation(DefaultSpriteLocation + Offset);
 }
 
 // meh
@@ -256,6 +360,8 @@ void URlCharacterMovementComponent::StartNewPhysics(float DeltaTime, int32 Itera
 // meh
 void URlCharacterMovementComponent::PhysWalking(float DeltaTime, int32 Iterations)
 {
+	RL_MOVEMENT_PHASE(PhysWalking);
+
 	if (DeltaTime < MIN_TICK_TIME)
 	{
 		return;
@@ -378,6 +484,8 @@ void URlCharacterMovementComponent::PhysWalking(float DeltaTime, int32 Iteration
 
 void URlCharacterMovementComponent::PhysFalling(float DeltaTime, int32 Iterations)
 {
+	RL_MOVEMENT_PHASE(PhysFalling);
+
 	if (DeltaTime < MIN_TICK_TIME)
 	{
 		return;
@@ -441,7 +549,7 @@ void URlCharacterMovementComponent::PhysFalling(float DeltaTime, int32 Iteration
 		// Move
 		FHitResult Hit(1.f);
 		FVector Adjusted = 0.5f*(OldVelocity + Velocity) * TimeTick;
-		SafeMoveUpdatedComponent(Adjusted, PawnRotation, true, Hit);
+		SafeMoveWithGrid(Adjusted, PawnRotation, Hit);
 
 		if (!HasValidData())
 		{
@@ -485,6 +593,7 @@ void URlCharacterMovementComponent::PhysFalling(float DeltaTime, int32 Iteration
 				if (subTimeTickRemaining > KINDA_SMALL_NUMBER && (Delta | Adjusted) > 0.f)
 				{
 					// Move in deflected direction.
+					RL_MOVEMENT_MOVE();
 					SafeMoveUpdatedComponent(Delta, PawnRotation, true, Hit);
 
 					if (Hit.bBlockingHit)
@@ -512,6 +621,7 @@ void URlCharacterMovementComponent::PhysFalling(float DeltaTime, int32 Iteration
 							const FVector NewVelocity = (Delta / subTimeTickRemaining);
 							Velocity = NewVelocity;
 						}
+						RL_MOVEMENT_MOVE();
 						SafeMoveUpdatedComponent(Delta, PawnRotation, true, Hit);
 					}
 				}
@@ -529,6 +639,8 @@ void URlCharacterMovementComponent::PhysFalling(float DeltaTime, int32 Iteration
 // meh
 void URlCharacterMovementComponent::PhysWallWalking(float DeltaTime, int32 Iterations)
 {
+	RL_MOVEMENT_PHASE(PhysWallWalking);
+
 	if (DeltaTime < MIN_TICK_TIME)
 	{
 		return;
@@ -1464,7 +1576,7 @@ void URlCharacterMovementComponent::MoveHorizontal(const FVector& InVelocity, fl
 	// Move along the current floor
 	const FVector Delta = FVector(InVelocity.X, InVelocity.Y, 0.f) * DeltaSeconds;
 	FHitResult Hit(1.f);
-	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+	SafeMoveWithGrid(Delta, UpdatedComponent->GetComponentQuat(), Hit);
 
 	float LastMoveTimeSlice = DeltaSeconds;
 
@@ -1713,6 +1825,8 @@ bool URlCharacterMovementComponent::IsWithinEdgeTolerance(const FVector& BoxLoca
 // meh
 void URlCharacterMovementComponent::ComputeFloorDist(const FVector& BoxLocation, float LineDistance, float SweepDistance, FRlFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult) const
 {
+	RL_MOVEMENT_PHASE(ComputeFloorDist);
+
 	OutFloorResult.Clear();
 
 	//float PawnRadius = CharacterOwner->GetBoxComponent()->GetScaledBoxExtent().X;
@@ -1862,6 +1976,8 @@ void URlCharacterMovementComponent::ComputeFloorDist(const FVector& BoxLocation,
 // meh
 void URlCharacterMovementComponent::FindFloor(const FVector& BoxLocation, FRlFindFloorResult& OutFloorResult, bool bCanUseCachedLocation, const FHitResult* DownwardSweepResult) const
 {
+	RL_MOVEMENT_PHASE(FindFloor);
+
 	// No collision, no floor...
 	if (!HasValidData() || !UpdatedComponent->IsQueryCollisionEnabled())
 	{
@@ -1931,6 +2047,38 @@ bool URlCharacterMovementComponent::FloorSweepTest(
 	const struct FCollisionResponseParams& ResponseParam
 ) const
 {
+	const FRlCollisionGrid* Grid = GetCollisionGrid();
+	if (Grid && CollisionShape.IsBox() && Start.X == End.X && Start.Y == End.Y && End.Z < Start.Z)
+	{
+		const FVector Extent = CollisionShape.GetExtent();
+		const FBox2D Box(FVector2D(Start.X - Extent.X, Start.Z - Extent.Z), FVector2D(Start.X + Extent.X, Start.Z + Extent.Z));
+		const float Distance = Start.Z - End.Z;
+
+		float HitDistance = 0.f;
+		const ERlGridResult Result = Grid->SweepDown(Box, Distance, HitDistance);
+
+		if (Result == ERlGridResult::Clear)
+		{
+			OutHit = FHitResult(Start, End);
+			return false;
+		}
+		if (Result == ERlGridResult::Blocked)
+		{
+			OutHit = FHitResult(Start, End);
+			OutHit.bBlockingHit = true;
+			OutHit.Time = FMath::Clamp(HitDistance / Distance, 0.f, 1.f);
+			OutHit.Distance = HitDistance;
+			OutHit.Location = Start - FVector(0.f, 0.f, HitDistance);
+			OutHit.ImpactPoint = FVector(Start.X, Start.Y, Box.Min.Y - HitDistance);
+			OutHit.Normal = FVector::UpVector;
+			OutHit.ImpactNormal = FVector::UpVector;
+			OutHit.Component = Grid->GetComponent();
+			OutHit.Actor = OutHit.Component.IsValid() ? OutHit.Component->GetOwner() : nullptr;
+			return true;
+		}
+	}
+
+	RL_MOVEMENT_SWEEP();
 	return GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, TraceChannel, CollisionShape, Params, ResponseParam);
 }
 
@@ -2075,6 +2223,8 @@ void URlCharacterMovementComponent::SprintStop()
 // meh
 bool URlCharacterMovementComponent::CheckSpikes()
 {
+	RL_MOVEMENT_PHASE(CheckSpikes);
+
 	FVector Start = UpdatedComponent->GetComponentLocation();
 
 	Start.X += FMath::Sign(Velocity.X) * 9.f;
@@ -2083,7 +2233,18 @@ bool URlCharacterMovementComponent::CheckSpikes()
 	FVector End = Start;
 	End.X -= FMath::Sign(Velocity.X) * 4.f;
 
+	// Only a hazard can make the trace hit a spike, the grid marks every tile they touch
+	if (const FRlCollisionGrid* Grid = GetCollisionGrid())
+	{
+		const FBox2D Segment(FVector2D(FMath::Min(Start.X, End.X), Start.Z), FVector2D(FMath::Max(Start.X, End.X), End.Z));
+		if (Grid->Overlap(Segment) != ERlGridResult::Unknown)
+		{
+			return false;
+		}
+	}
+
 	TArray<FHitResult> OutHits;
+	RL_MOVEMENT_SWEEP();
 	UKismetSystemLibrary::LineTraceMulti(this, Start, End, UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_WorldStatic), false, TArray<AActor*>(), EDrawDebugTrace::None, OutHits, true);
 	if (OutHits.Num() == 1)
 	{
@@ -2097,6 +2258,40 @@ bool URlCharacterMovementComponent::CheckSpikes()
 	return false;
 }
 
+const FRlCollisionGrid* URlCharacterMovementComponent::GetCollisionGrid() const
+{
+	if (!bUseCollisionGrid || !CharacterOwner)
+	{
+		return nullptr;
+	}
+
+	URlGameInstance* RlGI = Cast<URlGameInstance>(CharacterOwner->GetGameInstance());
+	const FRlCollisionGrid* Grid = RlGI && RlGI->LevelManager ? &RlGI->LevelManager->CollisionGrid : nullptr;
+	return Grid && Grid->IsValid() ? Grid : nullptr;
+}
+
+bool URlCharacterMovementComponent::SafeMoveWithGrid(const FVector& Delta, const FQuat& NewRotation, FHitResult& OutHit)
+{
+	if (const FRlCollisionGrid* Grid = GetCollisionGrid())
+	{
+		const FVector Location = UpdatedComponent->GetComponentLocation();
+		const FVector Extent = CharacterOwner->GetBoxComponent()->GetScaledBoxExtent();
+
+		FBox2D SweptBox(FVector2D(Location.X - Extent.X, Location.Z - Extent.Z), FVector2D(Location.X + Extent.X, Location.Z + Extent.Z));
+		SweptBox += SweptBox.ShiftBy(FVector2D(Delta.X, Delta.Z));
+
+		// Nothing to hit on the way, a teleport ends in the same place as the sweep
+		if (Grid->Overlap(SweptBox.ExpandBy(GRID_MOVE_MARGIN)) == ERlGridResult::Clear)
+		{
+			OutHit.Reset(1.f, false);
+			return MoveUpdatedComponent(Delta, NewRotation, false);
+		}
+	}
+
+	RL_MOVEMENT_MOVE();
+	return SafeMoveUpdatedComponent(Delta, NewRotation, true, OutHit);
+}
+
 // meh
 float URlCharacterMovementComponent::ComputeAnalogInputModifier() const
 {
@@ -9,6 +9,7 @@
 
 class ARlCharacter;
 class USceneComponent;
+struct FRlCollisionGrid;
 
 /** Movement modes for RlCharacters. */
 UENUM(BlueprintType)
@@ -345,6 +346,11 @@ public:
 
 	bool CheckSpikes();
 
+	/** Collision grid of the current level, or null if the grid is disabled or not built. */
+	const FRlCollisionGrid* GetCollisionGrid() const;
+
+	/** SafeMoveUpdatedComponent, without the sweep when the collision grid shows the moved box stays clear. */
+	bool SafeMoveWithGrid(const FVector& Delta, const FQuat& NewRotation, FHitResult& OutHit);
 
 
 
@@ -546,6 +552,44 @@ public:
 	UPROPERTY(Category="Character Movement: General Settings", EditAnywhere, BlueprintReadWrite, AdvancedDisplay, meta=(ClampMin="1", ClampMax="25", UIMin="1", UIMax="25"))
 	int32 MaxSimulationIterations;
 
+	/**
+	 * If true, movement is simulated in steps of exactly FixedTimeStep, independent of the frame rate, and the sprite is interpolated between the last two steps.
+	 * The same inputs give the same movement at any frame rate.
+	 */
+	UPROPERTY(Category="Character Movement: Fixed Time Step", EditAnywhere)
+	uint8 bUseFixedTimeStep:1;
+
+	/** Duration of each simulation step when bUseFixedTimeStep is true. */
+	UPROPERTY(Category="Character Movement: Fixed Time Step", EditAnywhere, meta=(ClampMin="0.001", UIMin="0.001", EditCondition="bUseFixedTimeStep"))
+	float FixedTimeStep;
+
+	/** Max number of steps simulated in a single frame, the remaining time is dropped so a long hitch does not stall the game. */
+	UPROPERTY(Category="Character Movement: Fixed Time Step", EditAnywhere, meta=(ClampMin="1", UIMin="1", EditCondition="bUseFixedTimeStep"))
+	int32 MaxFixedStepsPerFrame;
+
+	/** Number of fixed steps simulated since the component started. */
+	uint32 FixedStepCount;
+
+protected:
+
+	/** Simulation time not consumed by a fixed step yet. */
+	float FixedTimeAccumulator;
+
+	/** Location before and after the last fixed step, used to interpolate the sprite. */
+	FVector PreviousFixedLocation;
+	FVector CurrentFixedLocation;
+
+	/** Simulates as many fixed steps as fit in the accumulated time. */
+	void TickFixedTimeStep(float DeltaTime, const FVector& InputVector);
+
+	/** Simulates a single step of the character, shared by the variable and fixed time step modes. */
+	void SimulateStep(float DeltaTime, const FVector& InputVector);
+
+	/** Offsets the sprite between the last two fixed steps by the time left in the accumulator. */
+	void UpdateRenderInterpolation();
+
+public:
+
 
 
 
@@ -595,6 +639,13 @@ public:
 	UPROPERTY(Category="Character Movement: Walking", EditAnywhere, BlueprintReadWrite, AdvancedDisplay)
 	uint8 bAlwaysCheckFloor:1;
 
+	/**
+	 * Answers floor, wall and spike checks from the level collision grid instead of scene queries.
+	 * Queries touching hazards, partial tiles or moving actors still go to the engine.
+	 */
+	UPROPERTY(Category="Character Movement: General Settings", EditAnywhere)
+	uint8 bUseCollisionGrid:1;
+
 	///**
 	// * Performs floor checks as if the character is using a shape with a flat base.
 	// * This avoids the situation where characters slowly lower off the side of a ledge (as their capsule 'balances' on the edge).
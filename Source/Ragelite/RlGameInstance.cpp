@@ -6,7 +6,15 @@
 #include "AudioManager.h"
 #include "SpriteTextActor.h"
 #include "RlSpriteHUD.h"
+#include "BridgeManager.h"
+#include "SessionRecorder.h"
+#include "InputRecorder.h"
+#include "GhostRun.h"
+#include "FrameTimeOverlay.h"
+#include "LatencyTracer.h"
+#include "Misc/App.h"
 #include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogStatus, Log, All);
 
@@ -24,6 +32,25 @@ URlGameInstance::URlGameInstance(const FObjectInitializer& ObjectInitializer)
 	//bIntro = false;
 
 	UE_LOG(LogStatus, Log, TEXT("Use dynamic difficulty? %i"), bDynamicDifficulty);
+
+	bRecordSession = !FParse::Param(FCommandLine::Get(), TEXT("norecord"));
+
+	SessionRecorder = nullptr;
+	GhostRecorder = nullptr;
+
+	MaxGhosts = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("ghosts="), MaxGhosts);
+
+	FrameTimeOverlay = nullptr;
+
+	LatencyTracer = nullptr;
+
+	FixedTickRate = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("fixedtick="), FixedTickRate);
+
+	InputRecorder = nullptr;
+
+	bUseCollisionGrid = !FParse::Param(FCommandLine::Get(), TEXT("nocollisiongrid"));
 }
 
 void URlGameInstance::Init()
@@ -34,6 +61,59 @@ void URlGameInstance::Init()
 	WidgetManager = WidgetManagerClass->GetDefaultObject<UWidgetManager>();
 	WidgetManager->Init(this);
 
+	FString ReplayFilename;
+	if (FParse::Value(FCommandLine::Get(), TEXT("replayinput="), ReplayFilename))
+	{
+		InputRecorder = new FRlInputRecorder(ERlInputRecorderMode::Replay, ReplayFilename);
+		if (InputRecorder->IsValid())
+		{
+			// The recorded difficulty timeline replaces the device
+			bUseDevice = false;
+			bDynamicDifficulty = false;
+			bIntro = false;
+			FixedTickRate = InputRecorder->GetRecording().FixedTickRate;
+			FMath::RandInit(InputRecorder->GetRecording().Seed);
+
+			// Runs one fixed step per frame as fast as possible instead of in real time
+			if (FParse::Param(FCommandLine::Get(), TEXT("replayfast")))
+			{
+				FApp::SetUseFixedTimeStep(true);
+				FApp::SetFixedDeltaTime(1.0 / FixedTickRate);
+			}
+		}
+		else
+		{
+			delete InputRecorder;
+			InputRecorder = nullptr;
+		}
+	}
+	else if (FParse::Param(FCommandLine::Get(), TEXT("recordinput")))
+	{
+		FixedTickRate = FixedTickRate > 0 ? FixedTickRate : 120;
+		const FString Filename = FPaths::ProjectSavedDir() / TEXT("Inputs") / FDateTime::Now().ToString() + TEXT(".rlin");
+		InputRecorder = new FRlInputRecorder(ERlInputRecorderMode::Record, Filename, FixedTickRate);
+		FMath::RandInit(InputRecorder->GetRecording().Seed);
+	}
+
+	BridgeManager = NewObject<UBridgeManager>(this);
+	BridgeManager->Init(this);
+
+	FrameTimeOverlay = new FRlFrameTimeOverlay();
+
+	if (bUseDevice)
+	{
+		LatencyTracer = new FRlLatencyTracer();
+	}
+
+	if (bRecordSession)
+	{
+		const FString Filename = FPaths::ProjectSavedDir() / TEXT("Sessions") / FDateTime::Now().ToString() + TEXT(".rls");
+		SessionRecorder = new FRlSessionRecorder(Filename);
+		UE_LOG(LogStatus, Log, TEXT("Recording session to %s"), *Filename);
+
+		GhostRecorder = new FRlGhostRecorder(FRlGhostRecorder::GetDirectory() / FDateTime::Now().ToString() + TEXT(".rlgh"));
+	}
+
 	//AudioManager = AudioManagerClass->GetDefaultObject<AAudioManager>();
 
 	//FRotator SpawnRotation(0.f);
@@ -45,4 +125,49 @@ void URlGameInstance::Init()
 void URlGameInstance::Shutdown()
 {
 	OnShutdown.ExecuteIfBound();
+
+	if (BridgeManager)
+	{
+		BridgeManager->Shutdown();
+	}
+
+	if (SessionRecorder)
+	{
+		delete SessionRecorder;
+		SessionRecorder = nullptr;
+	}
+
+	if (InputRecorder)
+	{
+		delete InputRecorder;
+		InputRecorder = nullptr;
+	}
+
+	if (GhostRecorder)
+	{
+		delete GhostRecorder;
+		GhostRecorder = nullptr;
+	}
+
+	if (FrameTimeOverlay)
+	{
+		delete FrameTimeOverlay;
+		FrameTimeOverlay = nullptr;
+	}
+
+	if (LatencyTracer)
+	{
+		if (LatencyTracer->GetHistogram(ERlLatencyHop::ReceiptToHeartRate).Num())
+		{
+			const FString Filename = FRlLatencyTracer::GetDefaultFilename();
+			LatencyTracer->LogSummary();
+			if (LatencyTracer->Export(Filename))
+			{
+				UE_LOG(LogStatus, Log, TEXT("Latency histograms saved to %s"), *Filename);
+			}
+		}
+
+		delete LatencyTracer;
+		LatencyTracer = nullptr;
+	}
 }
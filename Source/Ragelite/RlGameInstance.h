@@ -13,6 +13,12 @@ class UWidgetManager;
 class AAudioManager;
 class ASpriteTextActor;
 class ARlSpriteHUD;
+class UBridgeManager;
+class FRlSessionRecorder;
+class FRlInputRecorder;
+class FRlGhostRecorder;
+class FRlFrameTimeOverlay;
+class FRlLatencyTracer;
 
 /**
  * 
@@ -46,12 +52,42 @@ public:
 
 	bool bIntro;
 
+	bool bRecordSession;
+
+	/** Simulation steps per second of the character movement, 0 to step with the frame rate. */
+	int32 FixedTickRate;
+
+	/** Floor, wall and spike checks use the level collision grid, disabled with -nocollisiongrid. */
+	bool bUseCollisionGrid;
+
+	/** Null unless the input is recorded (-recordinput) or replayed (-replayinput=<file>). */
+	FRlInputRecorder* InputRecorder;
+
+	/** Null when the session is not recorded. */
+	FRlSessionRecorder* SessionRecorder;
+
+	/** Records the run for ghost playback along with the session, null when the session is not recorded. */
+	FRlGhostRecorder* GhostRecorder;
+
+	/** Past level attempts drawn as ghosts on each level, set with -ghosts=<count>. */
+	int32 MaxGhosts;
+
+	/** Frame time percentiles and hitches, drawn with rl.FrameTimeOverlay 1. */
+	FRlFrameTimeOverlay* FrameTimeOverlay;
+
+	/** Heart rate to difficulty latency, exported to Saved/Latency on shutdown. Null without a device. */
+	FRlLatencyTracer* LatencyTracer;
+
 public:
 
 	ULevelManager* LevelManager;
 	UWidgetManager* WidgetManager;
 	UPROPERTY()
 	AAudioManager* AudioManager;
+	UPROPERTY()
+	UBridgeManager* BridgeManager;
+
+	TSubclassOf<ULevelManager> GetLevelManagerClass() const { return LevelManagerPtr; }
 
 private:
 
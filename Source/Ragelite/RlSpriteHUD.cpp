@@ -8,14 +8,43 @@
 #include "TimerManager.h"
 #include "RlGameMode.h"
 
-void ARlSpriteHUD::IncreaseLevel()
+namespace
 {
-	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
+	/** Writes Value with at least MinDigits digits and returns the end of the written characters. */
+	TCHAR* WriteNumber(TCHAR* Dest, int32 Value, int32 MinDigits = 1)
 	{
-		if (LevelText)
+		TCHAR Digits[16];
+		int32 NumDigits = 0;
+		do
+		{
+			Digits[NumDigits++] = TEXT('0') + Value % 10;
+			Value /= 10;
+		} while (Value > 0 || NumDigits < MinDigits);
+
+		while (NumDigits)
 		{
-			LevelText->SetText(FString::FromInt(++RlGI->Level));
+			*Dest++ = Digits[--NumDigits];
 		}
+		return Dest;
+	}
+}
+
+ARlSpriteHUD::ARlSpriteHUD()
+{
+	// Enabled when a field gets dirty, after everything else so a frame writes each field once
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	DirtyFields = 0;
+}
+
+void ARlSpriteHUD::IncreaseLevel()
+{
+	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
+	{
+		++RlGI->Level;
+		MarkDirty(ERlHUDField::Level);
 	}
 }
 
@@ -23,10 +52,8 @@ void ARlSpriteHUD::IncreaseScore()
 {
 	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
 	{
-		if (ScoreText)
-		{
-			ScoreText->SetText(FString::FromInt(++RlGI->Score));
-		}
+		++RlGI->Score;
+		MarkDirty(ERlHUDField::Score);
 	}
 }
 
@@ -34,22 +61,8 @@ void ARlSpriteHUD::IncreaseTime()
 {
 	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
 	{
-		if (TimeText)
-		{
-			int32 TempTime = ++RlGI->Time;
-			const int32 Seconds = TempTime % 60;
-			TempTime /= 60;
-			const int32 Minutes = TempTime % 60;
-			const int32 Hours = TempTime /= 60;
-			if (Hours)
-			{
-				TimeText->SetText(FString::Printf(TEXT("%02d:%02d:%02d"), Hours, Minutes, Seconds));
-			}
-			else
-			{
-				TimeText->SetText(FString::Printf(TEXT("%02d:%02d"), Minutes, Seconds));
-			}
-		}
+		++RlGI->Time;
+		MarkDirty(ERlHUDField::Time);
 	}
 }
 
@@ -57,13 +70,9 @@ void ARlSpriteHUD::IncreaseDeaths()
 {
 	if (URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance()))
 	{
-		if (DeathsText)
-		{
-			DeathsText->SetText(FString::FromInt(++RlGI->Deaths));
-		}
+		++RlGI->Deaths;
+		MarkDirty(ERlHUDField::Deaths);
 	}
-
-
 }
 
 void ARlSpriteHUD::ResetHUD()
@@ -75,14 +84,78 @@ void ARlSpriteHUD::ResetHUD()
 		RlGI->Time = 0;
 		RlGI->Deaths = 0;
 
-		if (ScoreText && TimeText  && DeathsText)
+		MarkDirty(ERlHUDField::All);
+	}
+}
+
+void ARlSpriteHUD::MarkDirty(ERlHUDField Field)
+{
+	if (!DirtyFields)
+	{
+		SetActorTickEnabled(true);
+	}
+	DirtyFields |= (uint8)Field;
+}
+
+void ARlSpriteHUD::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	FlushDirtyFields();
+}
+
+void ARlSpriteHUD::FlushDirtyFields()
+{
+	URlGameInstance* RlGI = Cast<URlGameInstance>(GetGameInstance());
+	if (!RlGI)
+	{
+		return;
+	}
+
+	TCHAR Buffer[16];
+
+	if (LevelText && (DirtyFields & (uint8)ERlHUDField::Level))
+	{
+		*WriteNumber(Buffer, RlGI->Level) = 0;
+		LevelText->SetText(Buffer);
+	}
+
+	if (ScoreText && (DirtyFields & (uint8)ERlHUDField::Score))
+	{
+		*WriteNumber(Buffer, RlGI->Score) = 0;
+		ScoreText->SetText(Buffer);
+	}
+
+	if (TimeText && (DirtyFields & (uint8)ERlHUDField::Time))
+	{
+		int32 TempTime = RlGI->Time;
+		const int32 Seconds = TempTime % 60;
+		TempTime /= 60;
+		const int32 Minutes = TempTime % 60;
+		const int32 Hours = TempTime / 60;
+
+		TCHAR* End = Buffer;
+		if (Hours)
 		{
-			LevelText->SetText(FString::FromInt(1));
-			ScoreText->SetText(FString::FromInt(0));
-			TimeText->SetText(FString("00:00"));
-			DeathsText->SetText(FString::FromInt(0));
+			End = WriteNumber(End, Hours, 2);
+			*End++ = TEXT(':');
 		}
+		End = WriteNumber(End, Minutes, 2);
+		*End++ = TEXT(':');
+		End = WriteNumber(End, Seconds, 2);
+		*End = 0;
+
+		TimeText->SetText(Buffer);
+	}
+
+	if (DeathsText && (DirtyFields & (uint8)ERlHUDField::Deaths))
+	{
+		*WriteNumber(Buffer, RlGI->Deaths) = 0;
+		DeathsText->SetText(Buffer);
 	}
+
+	DirtyFields = 0;
+	SetActorTickEnabled(false);
 }
 
 void ARlSpriteHUD::PostInitializeComponents()
@@ -102,7 +175,7 @@ void ARlSpriteHUD::BeginPlay()
 	ResetHUD();
 
 	GetWorld()->GetTimerManager().ClearTimer(TimeHandle);
-	GetWorld()->GetTimerManager().SetTimer(TimeHandle, this, &ARlSpriteHUD::TimeTick, 1.f, false);
+	GetWorld()->GetTimerManager().SetTimer(TimeHandle, this, &ARlSpriteHUD::TimeTick, 1.f, true);
 }
 
 void ARlSpriteHUD::TimeTick()
@@ -114,6 +187,4 @@ void ARlSpriteHUD::TimeTick()
 			IncreaseTime();
 		}
 	}
-
-	GetWorld()->GetTimerManager().SetTimer(TimeHandle, this, &ARlSpriteHUD::TimeTick, 1.f, false);
 }
\ No newline at end of file
@@ -8,12 +8,27 @@
 
 class ASpriteTextActor;
 
+/** Fields of the HUD, as bits of the dirty mask. */
+enum class ERlHUDField : uint8
+{
+	Level = 1 << 0,
+	Score = 1 << 1,
+	Time = 1 << 2,
+	Deaths = 1 << 3,
+	All = Level | Score | Time | Deaths
+};
+
+/**
+ * Level, score, time and deaths counters of the game instance drawn with sprite text.
+ * Changing a counter only marks its field dirty, the dirty fields are written once at the end of the frame.
+ */
 UCLASS()
 class RAGELITE_API ARlSpriteHUD : public AActor
 {
 	GENERATED_BODY()
 	
 public:
+	ARlSpriteHUD();
 
 	void IncreaseScore();
 	void IncreaseLevel();
@@ -24,6 +39,9 @@ public:
 
 	void PostInitializeComponents() override;
 
+	/** Writes the dirty fields, ticks only while some are dirty. */
+	virtual void Tick(float DeltaSeconds) override;
+
 
 protected:
 	virtual void BeginPlay() override;
@@ -47,6 +65,14 @@ private:
 private:
 	FTimerHandle TimeHandle;
 
+	/** Called every second by a looping timer. */
 	void TimeTick();
 
+	/** ERlHUDField bits of the fields to write at the end of the frame. */
+	uint8 DirtyFields;
+
+	void MarkDirty(ERlHUDField Field);
+
+	void FlushDirtyFields();
+
 };
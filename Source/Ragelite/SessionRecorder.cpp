@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionRecorder.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/Archive.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSessionRecorder, Log, All);
+
+namespace
+{
+	const uint8 Magic[4] = { 'R', 'L', 'S', 'S' };
+
+	void WriteVarInt(TArray<uint8>& Buffer, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Buffer.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Buffer.Add((uint8)Value);
+	}
+
+	bool ReadVarInt(const TArray<uint8>& Data, int32& Offset, uint64& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 64; Shift += 7)
+		{
+			if (Offset >= Data.Num())
+			{
+				return false;
+			}
+			const uint8 Byte = Data[Offset++];
+			OutValue |= (uint64)(Byte & 0x7f) << Shift;
+			if (!(Byte & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+FRlSessionRecorder::FRlSessionRecorder(const FString& InFilename, uint32 QueueSize)
+	: Filename(InFilename)
+	, Writer(nullptr)
+	, Thread(nullptr)
+	, WorkEvent(nullptr)
+	, Queue(QueueSize)
+	, bStopping(false)
+	, StartCycles(FPlatformTime::Cycles64())
+	, LastTime(0)
+{
+	Writer = IFileManager::Get().CreateFileWriter(*Filename);
+	if (!Writer)
+	{
+		UE_LOG(LogSessionRecorder, Warning, TEXT("Could not create %s"), *Filename);
+		return;
+	}
+
+	Buffer.Reserve(4096);
+	Buffer.Append(Magic, 4);
+	Buffer.Add(Version);
+	const int64 StartTime = FDateTime::Now().GetTicks();
+	Buffer.Append((const uint8*)&StartTime, sizeof(StartTime));
+
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("FRlSessionRecorder"), 0, TPri_Lowest);
+}
+
+FRlSessionRecorder::~FRlSessionRecorder()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+		WorkEvent = nullptr;
+	}
+
+	if (Writer)
+	{
+		Writer->Close();
+		delete Writer;
+		Writer = nullptr;
+	}
+
+	if (DroppedEvents.GetValue())
+	{
+		UE_LOG(LogSessionRecorder, Warning, TEXT("%i events dropped"), DroppedEvents.GetValue());
+	}
+}
+
+void FRlSessionRecorder::Record(ERlSessionEvent Type, float Value)
+{
+	if (Thread && !Queue.Enqueue(FRlSessionEvent(Type, Value, FPlatformTime::Cycles64())))
+	{
+		DroppedEvents.Increment();
+	}
+}
+
+uint32 FRlSessionRecorder::Run()
+{
+	while (!bStopping)
+	{
+		WorkEvent->Wait(1000);
+		Flush();
+	}
+
+	Flush();
+	return 0;
+}
+
+void FRlSessionRecorder::Stop()
+{
+	bStopping = true;
+	WorkEvent->Trigger();
+}
+
+void FRlSessionRecorder::Encode(const FRlSessionEvent& Event)
+{
+	const uint64 Time = (uint64)(FPlatformTime::ToSeconds64(Event.Time - StartCycles) * 1000000.0);
+	const uint64 Delta = Time > LastTime ? Time - LastTime : 0;
+	LastTime += Delta;
+
+	Buffer.Add((uint8)Event.Type);
+	WriteVarInt(Buffer, Delta);
+
+	switch (Event.Type)
+	{
+	case ERlSessionEvent::HeartRate:
+		Buffer.Add((uint8)FMath::Clamp(FMath::RoundToInt(Event.Value), 0, 255));
+		break;
+	case ERlSessionEvent::Difficulty:
+	{
+		const uint16 Difficulty = (uint16)FMath::RoundToInt(FMath::Clamp(Event.Value, 0.f, 1.f) * 65535.f);
+		Buffer.Add(Difficulty & 0xff);
+		Buffer.Add(Difficulty >> 8);
+		break;
+	}
+	case ERlSessionEvent::Level:
+		WriteVarInt(Buffer, (uint64)FMath::Max(FMath::RoundToInt(Event.Value), 0));
+		break;
+	default:
+		break;
+	}
+}
+
+void FRlSessionRecorder::Flush()
+{
+	FRlSessionEvent Event;
+	while (Queue.Dequeue(Event))
+	{
+		Encode(Event);
+	}
+
+	if (Buffer.Num())
+	{
+		Writer->Serialize(Buffer.GetData(), Buffer.Num());
+		Writer->Flush();
+		Buffer.Reset();
+	}
+}
+
+bool FRlSessionRecorder::Load(const FString& InFilename, TArray<FRlSessionEvent>& OutEvents, FDateTime* OutStartTime)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *InFilename))
+	{
+		return false;
+	}
+
+	const int32 HeaderSize = 4 + 1 + sizeof(int64);
+	if (Data.Num() < HeaderSize || FMemory::Memcmp(Data.GetData(), Magic, 4) || Data[4] != Version)
+	{
+		UE_LOG(LogSessionRecorder, Warning, TEXT("%s is not a session file"), *InFilename);
+		return false;
+	}
+
+	if (OutStartTime)
+	{
+		int64 Ticks;
+		FMemory::Memcpy(&Ticks, Data.GetData() + 5, sizeof(Ticks));
+		*OutStartTime = FDateTime(Ticks);
+	}
+
+	OutEvents.Reset();
+
+	int32 Offset = HeaderSize;
+	uint64 Time = 0;
+	while (Offset < Data.Num())
+	{
+		FRlSessionEvent Event;
+		Event.Type = (ERlSessionEvent)Data[Offset++];
+
+		uint64 Delta;
+		if (!ReadVarInt(Data, Offset, Delta))
+		{
+			break;
+		}
+		Time += Delta;
+		Event.Time = Time;
+
+		bool bValid = true;
+		switch (Event.Type)
+		{
+		case ERlSessionEvent::HeartRate:
+			bValid = Offset < Data.Num();
+			if (bValid)
+			{
+				Event.Value = Data[Offset++];
+			}
+			break;
+		case ERlSessionEvent::Difficulty:
+			bValid = Offset + 1 < Data.Num();
+			if (bValid)
+			{
+				Event.Value = (Data[Offset] | (Data[Offset + 1] << 8)) / 65535.f;
+				Offset += 2;
+			}
+			break;
+		case ERlSessionEvent::Level:
+		{
+			uint64 Level;
+			bValid = ReadVarInt(Data, Offset, Level);
+			Event.Value = (float)Level;
+			break;
+		}
+		case ERlSessionEvent::Death:
+		case ERlSessionEvent::CalibrationStart:
+		case ERlSessionEvent::CalibrationEnd:
+			break;
+		default:
+			bValid = false;
+			break;
+		}
+
+		// A truncated record can only be the last one, written while the game was closing
+		if (!bValid)
+		{
+			break;
+		}
+
+		OutEvents.Add(Event);
+	}
+
+	return true;
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/CircularQueue.h"
+
+class FArchive;
+class FRunnableThread;
+class FEvent;
+
+enum class ERlSessionEvent : uint8
+{
+	/** Value: beats per minute. */
+	HeartRate = 0,
+	/** Value: difficulty in [0, 1]. */
+	Difficulty = 1,
+	Death = 2,
+	/** Value: level index. */
+	Level = 3,
+	CalibrationStart = 4,
+	CalibrationEnd = 5
+};
+
+struct FRlSessionEvent
+{
+	ERlSessionEvent Type;
+
+	float Value;
+
+	/** FPlatformTime cycles while queued, microseconds since the start of the session once written or loaded. */
+	uint64 Time;
+
+	FRlSessionEvent() : Type(ERlSessionEvent::Death), Value(0.f), Time(0) {};
+
+	FRlSessionEvent(ERlSessionEvent InType, float InValue, uint64 InTime) : Type(InType), Value(InValue), Time(InTime) {};
+};
+
+/**
+ * Records the session events to a compact binary file (.rls).
+ * The game thread only pushes fixed size events to a ring buffer, a worker thread encodes them and writes them to disk.
+ *
+ * File layout: "RLSS", uint8 version, int64 start time in FDateTime ticks, then one record per event:
+ * uint8 type, varint microseconds since the previous event, and the payload (uint8 heart rate, uint16 difficulty / 65535, or varint level).
+ */
+class RAGELITE_API FRlSessionRecorder : public FRunnable
+{
+public:
+	static const uint8 Version = 1;
+
+	FRlSessionRecorder(const FString& InFilename, uint32 QueueSize = 1024);
+
+	virtual ~FRlSessionRecorder();
+
+	/** Game thread only. Drops the event if the ring buffer is full. */
+	void Record(ERlSessionEvent Type, float Value = 0.f);
+
+	const FString& GetFilename() const { return Filename; }
+
+	/** Decodes a session file written by the recorder. */
+	static bool Load(const FString& Filename, TArray<FRlSessionEvent>& OutEvents, FDateTime* OutStartTime = nullptr);
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+private:
+	FString Filename;
+
+	FArchive* Writer;
+
+	FRunnableThread* Thread;
+
+	FEvent* WorkEvent;
+
+	TCircularQueue<FRlSessionEvent> Queue;
+
+	FThreadSafeBool bStopping;
+
+	FThreadSafeCounter DroppedEvents;
+
+	uint64 StartCycles;
+
+	uint64 LastTime;
+
+	/** Encoded records waiting to be written. */
+	TArray<uint8> Buffer;
+
+	void Encode(const FRlSessionEvent& Event);
+
+	void Flush();
+};
@@ -1,6 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SpriteTextActor.h"
+#include "Ragelite.h"
+#include "SpriteTextComponent.h"
 #include "ConstructorHelpers.h"
 #include "PaperSpriteComponent.h"
 #include "PaperSprite.h"
@@ -8,6 +10,8 @@
 
 #include "Kismet/KismetSystemLibrary.h"
 
+DECLARE_CYCLE_STAT(TEXT("Sprite Text SetText"), STAT_RlSetText, STATGROUP_Ragelite);
+
 ASpriteTextActor::ASpriteTextActor(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -15,6 +19,8 @@ ASpriteTextActor::ASpriteTextActor(const FObjectInitializer& ObjectInitializer)
 	RootComponent = SceneComponent;
 	STSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("TextSceneComponent"));
 	STSceneComponent->SetupAttachment(RootComponent);
+	SpriteTextComponent = CreateDefaultSubobject<USpriteTextComponent>(TEXT("SpriteTextComponent"));
+	SpriteTextComponent->SetupAttachment(STSceneComponent);
 
 	static ConstructorHelpers::FObjectFinder<UMaterialInterface> MaterialRef(TEXT("/Paper2D/MaskedUnlitSpriteMaterial"));
 
@@ -28,73 +34,123 @@ ASpriteTextActor::ASpriteTextActor(const FObjectInitializer& ObjectInitializer)
 	TileHeight = 16;
 	TextLenght = 1;
 
+	FMemory::Memzero(Glyphs);
+
 	//for (TCHAR i = 48; i < 91; ++i)
 	//{
 	//	CharacterMap.Add(FString(1, &i), nullptr);
 	//}
 }
 
-void ASpriteTextActor::SetText(FString InText)
+void ASpriteTextActor::SetText(const FString& InText)
 {
-	Text = InText;
+	SetText(*InText);
+}
 
-	UpdateHorizontal();
-	UpdateSprites();
-	UpdateAlignment();
+void ASpriteTextActor::SetText(const TCHAR* InText)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RlSetText);
+
+	const int32 Len = FCString::Strlen(InText);
+	const int32 OldLen = Text.Len();
+
+	bool bChanged = Len != OldLen;
+	for (int32 i = 0; i < Len && !bChanged; ++i)
+	{
+		bChanged = Text[i] != InText[i];
+	}
+
+	if (!bChanged)
+	{
+		return;
+	}
+
+	// Only glyphs that differ, plus the ones past the end of a shorter text
+	for (int32 i = 0; i < FMath::Min(Len, OldLen); ++i)
+	{
+		if (Text[i] != InText[i])
+		{
+			SpriteTextComponent->SetInstanceSprite(i, GetGlyph(InText[i]));
+		}
+	}
+
+	for (int32 i = Len; i < OldLen; ++i)
+	{
+		SpriteTextComponent->SetInstanceSprite(i, nullptr);
+	}
+
+	// Keeps the allocation of the previous text
+	Text.Reset();
+	Text.AppendChars(InText, Len);
+	TextLenght = Len;
+
+	if (Len > OldLen)
+	{
+		UpdateHorizontal();
+
+		for (int32 i = OldLen; i < Len; ++i)
+		{
+			SpriteTextComponent->SetInstanceSprite(i, GetGlyph(InText[i]));
+		}
+	}
+
+	SpriteTextComponent->MarkRenderStateDirty();
+
+	if (Len != OldLen)
+	{
+		UpdateAlignment();
+	}
 }
 
-void ASpriteTextActor::UpdateMaterial()
+void ASpriteTextActor::BuildGlyphTable()
 {
-	for (UPaperSpriteComponent* PaperSpriteComponent : SpriteTextComponents)
+	FMemory::Memzero(Glyphs);
+
+	for (const TPair<FString, UPaperSprite*>& Character : CharacterMap)
 	{
-		PaperSpriteComponent->SetMaterial(0, Material);
+		if (Character.Key.Len() == 1 && (uint32)Character.Key[0] < 256)
+		{
+			Glyphs[Character.Key[0]] = Character.Value;
+		}
 	}
 }
 
+void ASpriteTextActor::UpdateMaterial()
+{
+	SpriteTextComponent->SetInstancesMaterial(Material);
+}
+
 void ASpriteTextActor::UpdateSprites()
 {
-	for (int i = 0; i < SpriteTextComponents.Num(); ++i)
+	// Instances past the end of the text are kept without a sprite for longer texts
+	for (int i = 0; i < SpriteTextComponent->GetInstanceCount(); ++i)
 	{
-		UPaperSpriteComponent* PaperSpriteComponent = SpriteTextComponents[i];
-		FString Key = FString::Chr(Text[i]);
-		PaperSpriteComponent->SetSprite(CharacterMap.Contains(Key) ? CharacterMap[Key] : nullptr);
+		SpriteTextComponent->SetInstanceSprite(i, i < Text.Len() ? GetGlyph(Text[i]) : nullptr);
 	}
+
+	SpriteTextComponent->MarkRenderStateDirty();
 }
 
 void ASpriteTextActor::UpdateLocationHorizontal()
 {
-	for (int i = 0; i < SpriteTextComponents.Num(); ++i)
+	for (int i = 0; i < SpriteTextComponent->GetInstanceCount(); ++i)
 	{
-		SpriteTextComponents[i]->SetRelativeLocation(FVector(TileWidth * i, 0.f, 0.f));
+		SpriteTextComponent->UpdateInstanceTransform(i, FTransform(FVector(TileWidth * i, 0.f, 0.f)));
 	}
+
+	SpriteTextComponent->MarkRenderStateDirty();
 }
 
 void ASpriteTextActor::UpdateHorizontal()
 {
-	while (SpriteTextComponents.Num() < Text.Len())
-	{
-		UPaperSpriteComponent* PaperSpriteComponent = NewObject<UPaperSpriteComponent>(this);
-		PaperSpriteComponent->SetMaterial(0, Material);
-		FString Key = FString::Chr(Text[SpriteTextComponents.Num()]);
-		if (CharacterMap.Contains(Key) && CharacterMap[Key])
-		{
-			PaperSpriteComponent->SetSprite(CharacterMap[Key]);
-		}
-		PaperSpriteComponent->SetRelativeLocation(FVector(TileWidth * SpriteTextComponents.Num(), 0.f, 0.f));
-		PaperSpriteComponent->SetupAttachment(STSceneComponent);
-		PaperSpriteComponent->RegisterComponent();
-		SpriteTextComponents.Add(PaperSpriteComponent);
-	}
+	const int32 NumInstances = SpriteTextComponent->GetInstanceCount();
 
-	while (SpriteTextComponents.Num() > Text.Len())
+	for (int i = NumInstances; i < Text.Len(); ++i)
 	{
-		UPaperSpriteComponent* PaperSpriteComponent = SpriteTextComponents.Pop();
-		PaperSpriteComponent->DestroyComponent();
+		SpriteTextComponent->AddInstanceWithMaterial(FTransform(FVector(TileWidth * i, 0.f, 0.f)), nullptr, Material);
 	}
 
 	TextLenght = Text.Len();
-
-	UpdateLocationHorizontal();
 }
 
 void ASpriteTextActor::UpdateAlignment()
@@ -134,6 +190,17 @@ void ASpriteTextActor::PostLoad()
 {
 	Super::PostLoad();
 
+	for (UPaperSpriteComponent* PaperSpriteComponent : SpriteTextComponents_DEPRECATED)
+	{
+		if (PaperSpriteComponent)
+		{
+			PaperSpriteComponent->DestroyComponent();
+		}
+	}
+	SpriteTextComponents_DEPRECATED.Empty();
+
+	BuildGlyphTable();
+
 	UpdateHorizontal();
 	UpdateMaterial();
 	UpdateSprites();
@@ -141,6 +208,18 @@ void ASpriteTextActor::PostLoad()
 	UpdateAlignment();
 }
 
+void ASpriteTextActor::PostActorCreated()
+{
+	Super::PostActorCreated();
+
+	BuildGlyphTable();
+
+	UpdateHorizontal();
+	UpdateMaterial();
+	UpdateSprites();
+	UpdateAlignment();
+}
+
 #if WITH_EDITOR
 void ASpriteTextActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
@@ -166,6 +245,7 @@ void ASpriteTextActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyCha
 	}
 	if (PropertyName == GET_MEMBER_NAME_CHECKED(ASpriteTextActor, CharacterMap))
 	{
+		BuildGlyphTable();
 		UpdateSprites();
 		UpdateLocationHorizontal();
 	}
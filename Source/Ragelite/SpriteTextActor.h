@@ -31,7 +31,11 @@ class RAGELITE_API ASpriteTextActor : public AActor
 	GENERATED_UCLASS_BODY()
 
 public:
-	void SetText(FString InText);
+	/** Does nothing if the text is the same. Allocates nothing unless the text is longer than any before. */
+	void SetText(const FString& InText);
+
+	/** Same as the FString version, only the glyphs that differ from the current text are changed. */
+	void SetText(const TCHAR* InText);
 
 private:
 
@@ -62,11 +66,23 @@ private:
 	UPROPERTY(Category = SpriteText, EditAnywhere)
 	TMap<FString, UPaperSprite*> CharacterMap;
 
+	/** One instance per character. */
 	UPROPERTY(Category = SpriteText, VisibleAnywhere)
-	TArray<class UPaperSpriteComponent*> SpriteTextComponents;
+	class USpriteTextComponent* SpriteTextComponent;
+
+	/** Sprite components of the old per character layout, destroyed on load. */
+	UPROPERTY()
+	TArray<class UPaperSpriteComponent*> SpriteTextComponents_DEPRECATED;
+
+	/** CharacterMap indexed by character code, characters above 255 have no sprite. */
+	UPaperSprite* Glyphs[256];
 
 	int TextLenght;
 
+	void BuildGlyphTable();
+
+	UPaperSprite* GetGlyph(TCHAR Character) const { return (uint32)Character < 256 ? Glyphs[Character] : nullptr; }
+
 	void UpdateMaterial();
 
 	void UpdateSprites();
@@ -81,6 +97,8 @@ public:
 
 	virtual void PostLoad() override;
 
+	virtual void PostActorCreated() override;
+
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpriteTextComponent.h"
+#include "Paper2D/Classes/PaperSprite.h"
+
+USpriteTextComponent::USpriteTextComponent()
+{
+	SetCollisionProfileName(FName("NoCollision"));
+	SetGenerateOverlapEvents(false);
+	SetCanEverAffectNavigation(false);
+}
+
+void USpriteTextComponent::SetInstanceSprite(int32 InstanceIndex, UPaperSprite* Sprite)
+{
+	if (PerInstanceSpriteData.IsValidIndex(InstanceIndex))
+	{
+		PerInstanceSpriteData[InstanceIndex].SourceSprite = Sprite;
+	}
+}
+
+void USpriteTextComponent::SetInstancesMaterial(UMaterialInterface* Material)
+{
+	InstanceMaterials.Reset();
+	InstanceMaterials.Add(Material);
+
+	for (FSpriteInstanceData& InstanceData : PerInstanceSpriteData)
+	{
+		InstanceData.MaterialIndex = 0;
+	}
+
+	MarkRenderStateDirty();
+}
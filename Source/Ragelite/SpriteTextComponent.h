@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Paper2D/Classes/PaperGroupedSpriteComponent.h"
+#include "SpriteTextComponent.generated.h"
+
+class UPaperSprite;
+class UMaterialInterface;
+
+/**
+ * Glyphs of a sprite text as instances of a single grouped sprite, one draw call for the whole text.
+ * Instances are kept when the text gets shorter and their sprite is changed in place, so changing the text allocates nothing.
+ */
+UCLASS()
+class RAGELITE_API USpriteTextComponent : public UPaperGroupedSpriteComponent
+{
+	GENERATED_BODY()
+
+public:
+	USpriteTextComponent();
+
+	/** Changes the sprite of an instance, null hides it. The render state is left to the caller to mark dirty. */
+	void SetInstanceSprite(int32 InstanceIndex, UPaperSprite* Sprite);
+
+	/** Draws every instance with the same material. */
+	void SetInstancesMaterial(UMaterialInterface* Material);
+};
@@ -12,7 +12,7 @@ AStone::AStone()
 	InRenderComponent->SetCollisionProfileName(FName("BlockAllDynamic"));
 }
 
-void AStone::Move(FVector Location, EHazardLocation HazardLocation)
+void AStone::GetPlacement(FVector Location, EHazardLocation HazardLocation, FVector& OutLocation, FRotator& OutRotation) const
 {
 	float HazardSize = TileSize / 2;
 	float HalfHazardSize = HazardSize / 2;
@@ -52,5 +52,6 @@ void AStone::Move(FVector Location, EHazardLocation HazardLocation)
 		break;
 	}
 
-	SetActorLocationAndRotation(Location, FRotator(0.f));
+	OutLocation = Location;
+	OutRotation = FRotator(0.f);
 }
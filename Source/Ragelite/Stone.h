@@ -17,6 +17,6 @@ class RAGELITE_API AStone : public AHazard
 public:
 	AStone();
 
-	void Move(FVector Location, EHazardLocation HazardLocation) override;
+	void GetPlacement(FVector Location, EHazardLocation HazardLocation, FVector& OutLocation, FRotator& OutRotation) const override;
 	
 };